@@ -0,0 +1,72 @@
+#include "gbuffer.glsl"
+#include "lighting.glsl"
+
+out vec4 out_color;
+
+// four texels per point light: its view space position and radius, then its
+// ambient, diffuse and specular colors
+uniform samplerBuffer pointLights;
+// per cluster: where its lights start in clusterLightIndices, and how many
+uniform usamplerBuffer clusters;
+uniform usamplerBuffer clusterLightIndices;
+
+uniform ivec3 clusterCounts;
+uniform vec2 screenResolution;
+uniform float zNear;
+// clusterCounts.z / log(zFar / zNear)
+uniform float clusterDepthScale;
+
+// only the directional lights are read from here; the point lights are
+// clustered instead
+layout(std140) uniform Lights {
+    PointLight pointLightArray[MAX_POINT_LIGHTS];
+    DirectionalLight directionalLights[MAX_DIRECTIONAL_LIGHTS];
+    int pointLightCount;
+    int directionalLightCount;
+};
+
+int getClusterIndex(vec2 uv, float depth) {
+    ivec3 cluster = ivec3(
+          ivec2(uv * vec2(clusterCounts.xy)),
+          int(floor(log(max(depth, zNear) / zNear) * clusterDepthScale)));
+    cluster = clamp(cluster, ivec3(0), clusterCounts - ivec3(1));
+    return cluster.x +
+           clusterCounts.x * (cluster.y + clusterCounts.y * cluster.z);
+}
+
+void main() {
+    vec2 uv = gl_FragCoord.xy / screenResolution;
+
+    GBufferSample g = readGBuffer(uv);
+    vec4 diffuseColor = g.diffuse;
+    vec3 position = g.position;
+    float specularColor = g.specular;
+    vec3 normal = g.normal;
+    float roughness = g.roughness;
+
+    out_color = vec4(0.0);
+
+    uvec2 cluster = texelFetch(clusters, getClusterIndex(uv, -position.z)).xy;
+    for (uint i = 0u; i < cluster.y; ++i) {
+        int light =
+              int(texelFetch(clusterLightIndices, int(cluster.x + i)).r) * 4;
+        vec4 positionRadius = texelFetch(pointLights, light);
+        vec3 lightPosition = positionRadius.xyz;
+        float attenuation = getAttenuation(
+              positionRadius.w, length(lightPosition - position));
+        out_color +=
+              getLightColor(diffuseColor, specularColor, position, normal,
+                            roughness, texelFetch(pointLights, light + 1).rgb,
+                            texelFetch(pointLights, light + 2).rgb,
+                            texelFetch(pointLights, light + 3).rgb,
+                            normalize(lightPosition - position)) *
+              attenuation;
+    }
+
+    for (int i = 0; i < directionalLightCount; ++i) {
+        out_color += getLightColor(
+              diffuseColor, specularColor, position, normal, roughness,
+              directionalLights[i].ambient, directionalLights[i].diffuse,
+              directionalLights[i].specular, directionalLights[i].direction);
+    }
+}
@@ -0,0 +1,94 @@
+// how the G-buffer is laid out (see GBuffer::Layout). the geometry pass
+// writes it with encodeGBuffer, and the lighting passes read it back with
+// readGBuffer. GBuffer::shaderSources defines GBUFFER_LAYOUT as one of these,
+// so each program only has the code for its layout.
+#define GBUFFER_LAYOUT_FULL 0
+#define GBUFFER_LAYOUT_COMPACT 1
+
+layout(std140) uniform GBuffer {
+    mat4 inverseProjection;
+};
+
+uniform sampler2D gBuffer0;
+uniform sampler2D gBuffer1;
+uniform sampler2D gBuffer2;
+uniform sampler2D gBufferDepth;
+
+struct GBufferSample {
+    vec3 position;
+    vec3 normal;
+    vec4 diffuse;
+    float specular;
+    float roughness;
+};
+
+// octahedral: the unit sphere folded out onto a square, two channels instead
+// of three. the square is moved to [0, 1] so unsigned formats can hold it.
+vec2 signNotZero(vec2 v) {
+    return vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+}
+vec2 encodeNormal(vec3 n) {
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    vec2 e = n.z >= 0.0 ? n.xy : (1.0 - abs(n.yx)) * signNotZero(n.xy);
+    return e * 0.5 + 0.5;
+}
+vec3 decodeNormal(vec2 e) {
+    e = e * 2.0 - 1.0;
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0) {
+        n.xy = (1.0 - abs(n.yx)) * signNotZero(n.xy);
+    }
+    return normalize(n);
+}
+
+// roughness is a specular exponent, so it's stored logarithmically. 8 bits
+// covers 1 to 2048 in steps of about 3%.
+float encodeRoughness(float roughness) {
+    return log2(max(roughness, 1.0)) / 11.0;
+}
+float decodeRoughness(float e) {
+    return exp2(e * 11.0);
+}
+
+void encodeGBuffer(vec3 position,
+                   vec3 normal,
+                   vec4 diffuse,
+                   float specular,
+                   float roughness,
+                   out vec4 target0,
+                   out vec4 target1,
+                   out vec4 target2) {
+#if GBUFFER_LAYOUT == GBUFFER_LAYOUT_COMPACT
+    target0 = vec4(encodeNormal(normal), 0.0, 0.0);
+    target1 = vec4(specular, encodeRoughness(roughness), 0.0, 0.0);
+#else
+    target0 = vec4(position, specular);
+    // the normal is normalized when it's read back
+    target1 = vec4(normal, roughness);
+#endif
+    target2 = diffuse;
+}
+
+// uv covers the whole G-buffer
+GBufferSample readGBuffer(vec2 uv) {
+    GBufferSample s;
+#if GBUFFER_LAYOUT == GBUFFER_LAYOUT_COMPACT
+    float depth = texture(gBufferDepth, uv).r;
+    vec4 position = inverseProjection * vec4(vec3(uv, depth) * 2.0 - 1.0, 1.0);
+    s.position = position.xyz / position.w;
+    s.normal = decodeNormal(texture(gBuffer0, uv).xy);
+    vec4 specularRoughness = texture(gBuffer1, uv);
+    s.specular = specularRoughness.r;
+    s.roughness = decodeRoughness(specularRoughness.g);
+#else
+    vec4 positionSpecular = texture(gBuffer0, uv);
+    s.position = positionSpecular.xyz;
+    s.specular = positionSpecular.a;
+    vec4 normalRoughness = texture(gBuffer1, uv);
+    s.normal = normalize(normalRoughness.xyz);
+    s.roughness = normalRoughness.a;
+#endif
+    // whether the target has alpha depends on its format
+    s.diffuse = vec4(texture(gBuffer2, uv).rgb, 1.0);
+    return s;
+}
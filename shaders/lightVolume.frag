@@ -0,0 +1,50 @@
+#include "gbuffer.glsl"
+#include "lighting.glsl"
+
+// LightVolumeTechnique_base builds this once per kind of light, with
+// LIGHT_TYPE defined as one of these
+#define LIGHT_TYPE_POINT 0
+#define LIGHT_TYPE_POINT_INSTANCED 1
+#define LIGHT_TYPE_DIRECTIONAL 2
+
+out vec4 out_color;
+
+#if LIGHT_TYPE == LIGHT_TYPE_POINT
+uniform PointLight light;
+#elif LIGHT_TYPE == LIGHT_TYPE_POINT_INSTANCED
+in vec3 lightAmbient;
+in vec3 lightDiffuse;
+in vec3 lightSpecular;
+
+in vec3 lightPosition;
+in float lightRadius;
+#else
+uniform DirectionalLight light;
+#endif
+
+uniform vec2 screenResolution;
+
+void main() {
+    vec2 uv = gl_FragCoord.xy / screenResolution;
+
+    GBufferSample g = readGBuffer(uv);
+
+#if LIGHT_TYPE == LIGHT_TYPE_DIRECTIONAL
+    out_color = getLightColor(g.diffuse, g.specular, g.position, g.normal,
+                              g.roughness, light.ambient, light.diffuse,
+                              light.specular, normalize(light.direction));
+#else
+#if LIGHT_TYPE == LIGHT_TYPE_POINT
+    vec3 lightAmbient = light.ambient;
+    vec3 lightDiffuse = light.diffuse;
+    vec3 lightSpecular = light.specular;
+    vec3 lightPosition = light.position;
+    float lightRadius = light.radius;
+#endif
+    vec3 lightVec = lightPosition - g.position;
+    out_color = getLightColor(g.diffuse, g.specular, g.position, g.normal,
+                              g.roughness, lightAmbient, lightDiffuse,
+                              lightSpecular, normalize(lightVec)) *
+                getAttenuation(lightRadius, length(lightVec));
+#endif
+}
@@ -12,8 +12,10 @@ out vec3 lightSpecular;
 out vec3 lightPosition;
 out float lightRadius;
 
-uniform mat4 view;
-uniform mat4 projection;
+layout(std140) uniform Camera {
+    mat4 view;
+    mat4 projection;
+};
 
 void main() {
     vec4 pos = projection * view * vec4(worldPos + position * radius, 1.0);
@@ -0,0 +1,49 @@
+// the lights as the lighting passes are given them, in view space, and how
+// they light a surface
+
+#define MAX_POINT_LIGHTS 64
+struct PointLight {
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+
+    vec3 position;
+    float radius;
+};
+
+#define MAX_DIRECTIONAL_LIGHTS 8
+struct DirectionalLight {
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+
+    vec3 direction;
+};
+
+// Blinn-Phong. lightDir points from the surface to the light.
+vec4 getLightColor(vec4 diffuseColor,
+                   float specularVal,
+                   vec3 positionVal,
+                   vec3 normalVal,
+                   float roughness,
+                   vec3 lightAmbient,
+                   vec3 lightDiffuse,
+                   vec3 lightSpecular,
+                   vec3 lightDir) {
+    vec4 ambientResult = diffuseColor * vec4(lightAmbient, 1.0);
+
+    vec4 diffuseResult = diffuseColor * vec4(lightDiffuse, 1.0) *
+                         max(dot(normalVal, lightDir), 0.0);
+
+    vec3 cameraRay = -normalize(positionVal);
+    vec3 halfway = normalize(cameraRay + lightDir);
+    float specularFactor = max(dot(normalVal, halfway), 0.0);
+    vec3 specularResult =
+          lightSpecular * pow(specularFactor, roughness) * specularVal;
+    return ambientResult + diffuseResult + vec4(specularResult, 1.0);
+}
+
+float getAttenuation(float radius, float dist) {
+    return pow(clamp(1.0 - pow(dist / radius, 1.0), 0.0, 1.0), 2.0) /
+           (dist * dist + 1.0);
+}
@@ -1,6 +1,8 @@
-layout(location = 0) out vec4 out_positionRGB_specularA;
-layout(location = 1) out vec4 out_normalRGB_roughnessA;
-layout(location = 2) out vec4 out_diffuse;
+#include "gbuffer.glsl"
+
+layout(location = 0) out vec4 out_gBuffer0;
+layout(location = 1) out vec4 out_gBuffer1;
+layout(location = 2) out vec4 out_gBuffer2;
 
 uniform sampler2D diffuseTexture;
 uniform vec3 lightColor;
@@ -19,10 +21,8 @@ in vec4 frag_color;
 in vec3 frag_viewPosition;
 
 void main() {
-    out_positionRGB_specularA =
-          vec4(frag_viewPosition, texture(material.specular, frag_texCoord).r);
-    out_normalRGB_roughnessA = vec4(
-          frag_normal,
-          material.shininess);  // normal vector normalized in the deferred pass
-    out_diffuse = texture(material.diffuse, frag_texCoord) * frag_color;
+    encodeGBuffer(frag_viewPosition, frag_normal,
+                  texture(material.diffuse, frag_texCoord) * frag_color,
+                  texture(material.specular, frag_texCoord).r,
+                  material.shininess, out_gBuffer0, out_gBuffer1, out_gBuffer2);
 }
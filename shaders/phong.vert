@@ -3,7 +3,10 @@ layout(location = 1) in vec3 normal;
 layout(location = 2) in vec2 texCoord;
 layout(location = 3) in vec4 color;
 
-uniform mat4 projection;
+layout(std140) uniform Camera {
+    mat4 view;
+    mat4 projection;
+};
 uniform mat4 modelView;
 uniform mat3 normalMatrix;
 
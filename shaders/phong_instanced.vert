@@ -0,0 +1,25 @@
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 normal;
+layout(location = 2) in vec2 texCoord;
+layout(location = 3) in vec4 color;
+layout(location = 4) in mat4 modelView;
+layout(location = 8) in mat3 normalMatrix;
+
+layout(std140) uniform Camera {
+    mat4 view;
+    mat4 projection;
+};
+
+out vec2 frag_texCoord;
+out vec3 frag_normal;
+out vec4 frag_color;
+out vec3 frag_viewPosition;
+
+void main() {
+    frag_normal = normalMatrix * normal;
+    frag_texCoord = texCoord;
+    frag_color = color;
+    vec4 viewPosition = modelView * vec4(position, 1.0);
+    frag_viewPosition = vec3(viewPosition);
+    gl_Position = projection * viewPosition;
+}
@@ -1,4 +1,4 @@
-#define PP_DO_STEPS
+// SimplePostprocessingStep defines PP_DO_STEPS as calls to its steps, in order
 
 uniform sampler2D frameBufferTexture;
 
@@ -0,0 +1,415 @@
+#include "common/types.hpp"
+#include "data/fs.hpp"
+#include "gl/extensions.hpp"
+#include "gl/gl.hpp"
+#include "gl/gpu_profiler.hpp"
+#include "gl/program_cache.hpp"
+#include "gl/shader.hpp"
+#include "kepler_config.hpp"
+#include "renderer/postprocessing/simple_postprocessing_step.hpp"
+#include "renderer/renderer.hpp"
+#include "scene/camera.hpp"
+#include "scene/camera_path.hpp"
+#include "scene/demo_scene.hpp"
+#include "scene/scene.hpp"
+#include "util/random.hpp"
+#include "util/trace.hpp"
+#include "window/headless_context.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+USING_NS_KEPLER;
+
+// renders the demo scene headless along a recorded camera path, and writes
+// CPU and GPU frame time statistics as JSON. everything that could differ
+// between two runs (the scene, the camera, the time step) is fixed by the
+// options, so runs with the same options on the same machine can be compared
+// across commits.
+namespace {
+struct Options {
+    DemoSceneParams scene;
+    std::uint32_t seed = 1;
+    std::size_t frames = 1200;
+    std::size_t warmupFrames = 60;
+    std::string cameraPath;
+    Resolution resolution{1280, 720};
+    std::string technique = "volumes";
+    GBuffer::Layout gBufferLayout = GBuffer::Layout::Full;
+    std::string out = "bench.json";
+    std::string trace;
+    std::string programCache;
+};
+
+// the order Renderer::debug_cycleDeferredTechnique goes through them
+const std::vector<std::string> techniques{"volumes", "instanced", "simple",
+                                          "clustered"};
+
+// the same time step every frame, whatever the machine's speed
+constexpr auto timeStep = 1.f / 60.f;
+
+struct usage_error : std::runtime_error {
+    using runtime_error::runtime_error;
+};
+
+void printUsage() {
+    std::cerr
+          << "usage: kepler_bench [options]\n"
+             "  --objects N          crates in the scene (200)\n"
+             "  --lights N           point lights (63)\n"
+             "  --directional N      directional lights (1)\n"
+             "  --seed N             seed for the scene's layout (1)\n"
+             "  --frames N           frames to measure (1200)\n"
+             "  --warmup N           frames to render first, unmeasured (60)\n"
+             "  --path FILE          camera path to fly (res/bench/"
+             "flythrough.path)\n"
+             "  --resolution WxH     (1280x720)\n"
+             "  --technique NAME     volumes, instanced, simple or clustered\n"
+             "  --gbuffer LAYOUT     full or compact\n"
+             "  --out FILE           where the JSON goes (bench.json)\n"
+             "  --trace FILE         also write a trace of the measured "
+             "frames\n"
+             "  --program-cache FILE load and save linked programs there\n";
+}
+
+std::size_t parseCount(const std::string& option, const std::string& value) {
+    std::size_t end;
+    unsigned long count;
+    try {
+        count = std::stoul(value, &end);
+    } catch (const std::exception&) {
+        end = 0;
+    }
+    if (end == 0 || end != value.size()) {
+        throw usage_error{option + " takes a number, not \"" + value + '"'};
+    }
+    return count;
+}
+
+Options parseOptions(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string option = argv[i];
+        if (option == "--help") {
+            printUsage();
+            std::exit(0);
+        }
+        if (i + 1 == argc) {
+            throw usage_error{"missing a value for " + option};
+        }
+        const std::string value = argv[++i];
+        if (option == "--objects") {
+            options.scene.objects = parseCount(option, value);
+        } else if (option == "--lights") {
+            options.scene.pointLights = parseCount(option, value);
+        } else if (option == "--directional") {
+            options.scene.directionalLights = parseCount(option, value);
+        } else if (option == "--seed") {
+            options.seed =
+                  static_cast<std::uint32_t>(parseCount(option, value));
+        } else if (option == "--frames") {
+            options.frames =
+                  std::max<std::size_t>(parseCount(option, value), 1);
+        } else if (option == "--warmup") {
+            options.warmupFrames = parseCount(option, value);
+        } else if (option == "--path") {
+            options.cameraPath = value;
+        } else if (option == "--resolution") {
+            const auto x = value.find('x');
+            if (x == std::string::npos) {
+                throw usage_error{"--resolution takes WxH"};
+            }
+            options.resolution = Resolution{
+                  static_cast<int>(parseCount(option, value.substr(0, x))),
+                  static_cast<int>(parseCount(option, value.substr(x + 1)))};
+        } else if (option == "--technique") {
+            if (std::find(std::begin(techniques), std::end(techniques),
+                          value) == std::end(techniques)) {
+                throw usage_error{"unknown technique \"" + value + '"'};
+            }
+            options.technique = value;
+        } else if (option == "--gbuffer") {
+            if (value != "full" && value != "compact") {
+                throw usage_error{"unknown G-buffer layout \"" + value + '"'};
+            }
+            options.gBufferLayout = value == "full" ? GBuffer::Layout::Full
+                                                    : GBuffer::Layout::Compact;
+        } else if (option == "--out") {
+            options.out = value;
+        } else if (option == "--trace") {
+            options.trace = value;
+        } else if (option == "--program-cache") {
+            options.programCache = value;
+        } else {
+            throw usage_error{"unknown option " + option};
+        }
+    }
+    return options;
+}
+
+struct Summary {
+    float average;
+    float median;
+    float p95;
+    float p99;
+    float min;
+    float max;
+};
+
+// nearest rank, as GPUProfiler does
+float percentile(const std::vector<float>& sorted, float p) {
+    const auto rank = static_cast<std::size_t>(std::ceil(p * sorted.size()));
+    return sorted[std::max<std::size_t>(rank, 1) - 1];
+}
+
+Summary summarize(std::vector<float> samples) {
+    std::sort(std::begin(samples), std::end(samples));
+    const auto sum =
+          std::accumulate(std::begin(samples), std::end(samples), 0.f);
+    return {sum / samples.size(),      percentile(samples, .5f),
+            percentile(samples, .95f), percentile(samples, .99f),
+            samples.front(),           samples.back()};
+}
+
+// per frame, averaged over the measured ones
+struct Counters {
+    double stateChanges = 0;
+    double stateChangesFiltered = 0;
+    double drawCalls = 0;
+    double objectsDrawn = 0;
+    double objectsCulled = 0;
+    double pointLightsDrawn = 0;
+    double pointLightsCulled = 0;
+    double bytesStreamed = 0;
+
+    void add(const Renderer& renderer) {
+        const auto state = renderer.getLastFrameStateStats();
+        const auto culling = renderer.getLastFrameCullingStats();
+        stateChanges += state.issued;
+        stateChangesFiltered += state.filtered;
+        drawCalls += renderer.getLastFrameBatchingStats().drawCalls;
+        objectsDrawn += culling.objectsSubmitted;
+        objectsCulled += culling.objectsCulled;
+        pointLightsDrawn += culling.pointLightsSubmitted;
+        pointLightsCulled += culling.pointLightsCulled;
+        bytesStreamed += renderer.getLastFrameStreamingStats().bytesWritten;
+    }
+};
+
+// FNV-1a. the same options should render the same pixels, so a changed hash
+// means a commit changed what's drawn, not just how fast.
+std::uint64_t hashPixels(const std::vector<unsigned char>& pixels) {
+    std::uint64_t hash = 14695981039346656037ull;
+    for (const auto byte : pixels) {
+        hash = (hash ^ byte) * 1099511628211ull;
+    }
+    return hash;
+}
+
+std::string quoted(const std::string& str) {
+    std::string ret = "\"";
+    for (const auto c : str) {
+        if (c == '"' || c == '\\') {
+            ret += '\\';
+        }
+        ret += c;
+    }
+    return ret + '"';
+}
+
+std::string glString(GLenum name) {
+    const auto str = glGetString(name);
+    return str ? reinterpret_cast<const char*>(str) : "";
+}
+
+void writeSummary(std::ostream& out, const Summary& summary) {
+    out << "{\"average\": " << summary.average
+        << ", \"median\": " << summary.median << ", \"p95\": " << summary.p95
+        << ", \"p99\": " << summary.p99 << ", \"min\": " << summary.min
+        << ", \"max\": " << summary.max << '}';
+}
+
+int run(const Options& options) {
+    HeadlessContext context{options.resolution};
+    if (!options.programCache.empty()) {
+        ProgramCache::open(fs::AbsolutePath{options.programCache});
+    }
+
+    using clock = std::chrono::steady_clock;
+    auto milliseconds = [](clock::duration d) {
+        return std::chrono::duration<float, std::milli>{d}.count();
+    };
+    // everything up to the first frame being finished, which is mostly
+    // building programs
+    const auto startupBegin = clock::now();
+
+    util::seedRandom(options.seed);
+    const auto scene = makeDemoScene(options.scene);
+
+    const auto cameraPath = CameraPath::load(
+          options.cameraPath.empty()
+                ? fs::AbsolutePath{fs::RelativePath{
+                        "res/bench/flythrough.path"}}
+                : fs::AbsolutePath{options.cameraPath});
+
+    Renderer renderer{
+          options.resolution,
+          std::make_unique<PerspectiveCamera>(options.resolution),
+          std::make_unique<SimplePostprocessingStep>(
+                std::vector<SimplePostprocessingStep::StepDescriptor>{
+                      {"gamma_correction"},
+                }),
+          Renderer::TargetFormats::defaults(options.gBufferLayout)};
+    renderer.setOutputFramebuffer(context.getOutputFramebuffer());
+    renderer.setBackgroundColor({0.05f, 0.05f, 0.06f, 1.f});
+    const auto technique = std::find(std::begin(techniques),
+                                     std::end(techniques), options.technique) -
+                           std::begin(techniques);
+    for (auto i = technique; i > 0; --i) {
+        renderer.debug_cycleDeferredTechnique();
+    }
+
+    // fills the caches and buffers, at the start of the path with the scene
+    // standing still
+    cameraPath.apply(Seconds{0.f}, renderer.getCamera().transform());
+    renderer.renderScene(*scene);
+    context.finish();
+    const auto startupTime = milliseconds(clock::now() - startupBegin);
+    for (std::size_t i = 0; i < options.warmupFrames; ++i) {
+        renderer.renderScene(*scene);
+    }
+    context.finish();
+
+    GPUProfiler::clear();
+    GPUProfiler::setHistorySize(options.frames);
+    if (!options.trace.empty()) {
+        trace::captureFrames(options.frames);
+        trace::markFrame();
+    }
+
+    std::vector<float> cpuTimes;
+    std::vector<float> frameTimes;
+    cpuTimes.reserve(options.frames);
+    frameTimes.reserve(options.frames);
+    Counters counters;
+    // the path loops if there are more frames than it lasts
+    const auto duration = cameraPath.getDuration().rep();
+    for (std::size_t i = 0; i < options.frames; ++i) {
+        const auto time = i * timeStep;
+        const auto begin = clock::now();
+        cameraPath.apply(Seconds{duration > 0.f ? std::fmod(time, duration)
+                                                : 0.f},
+                         renderer.getCamera().transform());
+        scene->update(Seconds{timeStep});
+        renderer.renderScene(*scene);
+        const auto submitted = clock::now();
+        // so one frame's GPU work can't spill into the next one's time
+        context.finish();
+        const auto finished = clock::now();
+        cpuTimes.push_back(milliseconds(submitted - begin));
+        frameTimes.push_back(milliseconds(finished - begin));
+        counters.add(renderer);
+        if (trace::markFrame()) {
+            trace::writeJSON(fs::AbsolutePath{options.trace});
+        }
+    }
+    const auto pixels = context.readPixels();
+    GPUProfiler::flush();
+    const auto gpu = GPUProfiler::getStats();
+
+    std::ofstream out{options.out};
+    if (!out) {
+        throw fs::error_opening_file{options.out};
+    }
+    const auto frames = static_cast<double>(options.frames);
+    out << std::fixed << std::setprecision(4);
+    out << "{\n  \"config\": {\"objects\": " << options.scene.objects
+        << ", \"pointLights\": " << options.scene.pointLights
+        << ", \"directionalLights\": " << options.scene.directionalLights
+        << ", \"seed\": " << options.seed << ", \"frames\": " << options.frames
+        << ", \"warmupFrames\": " << options.warmupFrames
+        << ", \"cameraPath\": "
+        << quoted(options.cameraPath.empty() ? "res/bench/flythrough.path"
+                                             : options.cameraPath)
+        << ", \"resolution\": [" << options.resolution.width() << ", "
+        << options.resolution.height()
+        << "], \"technique\": " << quoted(options.technique)
+        << ", \"gBuffer\": "
+        << quoted(options.gBufferLayout == GBuffer::Layout::Full ? "full"
+                                                                 : "compact")
+        << ", \"timeStep\": " << timeStep << "},\n";
+    out << "  \"gl\": {\"renderer\": " << quoted(glString(GL_RENDERER))
+        << ", \"version\": " << quoted(glString(GL_VERSION))
+        << ", \"parallelShaderCompile\": "
+        << (GL::extensions::hasParallelShaderCompile() ? "true" : "false")
+        << "},\n";
+    const auto programs = ProgramCache::getStats();
+    out << "  \"startup\": " << startupTime
+        << ",\n  \"programCache\": {\"open\": "
+        << (ProgramCache::isOpen() ? "true" : "false")
+        << ", \"hits\": " << programs.hits
+        << ", \"misses\": " << programs.misses
+        << ", \"rejected\": " << programs.rejected << "},\n";
+    // in milliseconds, as is startup. cpu is the time to update the scene and
+    // submit the frame, and frame is that plus waiting for the GPU to finish
+    // it.
+    out << "  \"cpu\": ";
+    writeSummary(out, summarize(cpuTimes));
+    out << ",\n  \"frame\": ";
+    writeSummary(out, summarize(frameTimes));
+    out << ",\n  \"gpu\": {\"framesTimed\": " << gpu.framesTimed
+        << ", \"framesDropped\": " << gpu.framesDropped << ", \"passes\": [";
+    for (std::size_t i = 0; i < gpu.passes.size(); ++i) {
+        const auto& pass = gpu.passes[i];
+        out << (i ? ",\n" : "\n") << "    {\"pass\": " << quoted(pass.path)
+            << ", \"samples\": " << pass.samples
+            << ", \"average\": " << pass.average
+            << ", \"median\": " << pass.median << ", \"p95\": " << pass.p95
+            << ", \"p99\": " << pass.p99 << ", \"max\": " << pass.max << '}';
+    }
+    out << "]},\n";
+    out << "  \"perFrame\": {\"stateChanges\": "
+        << counters.stateChanges / frames << ", \"stateChangesFiltered\": "
+        << counters.stateChangesFiltered / frames
+        << ", \"drawCalls\": " << counters.drawCalls / frames
+        << ", \"objectsDrawn\": " << counters.objectsDrawn / frames
+        << ", \"objectsCulled\": " << counters.objectsCulled / frames
+        << ", \"pointLightsDrawn\": " << counters.pointLightsDrawn / frames
+        << ", \"pointLightsCulled\": " << counters.pointLightsCulled / frames
+        << ", \"bytesStreamed\": " << counters.bytesStreamed / frames
+        << "},\n";
+    out << "  \"lastFrameHash\": \"" << std::hex << std::setw(16)
+        << std::setfill('0') << hashPixels(pixels) << "\"\n}\n";
+
+    const auto frame = summarize(frameTimes);
+    std::cout << options.frames << " frames: " << frame.average
+              << " ms average, " << frame.p99 << " ms p99; written to "
+              << options.out << '\n';
+
+    GPUProfiler::clear();
+    Shader::clearCache();
+    ProgramCache::close();
+    return 0;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+    try {
+        return run(parseOptions(argc, argv));
+    } catch (const usage_error& e) {
+        std::cerr << e.what() << '\n';
+        printUsage();
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << '\n';
+    }
+    return 1;
+}
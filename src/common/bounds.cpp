@@ -0,0 +1,97 @@
+#include "common/bounds.hpp"
+
+#include <cmath>
+
+NS_KEPLER_BEGIN
+
+BoundingSphere transformed(const BoundingSphere& sphere,
+                           const Transform& transform) {
+    const auto& scale = transform.scale.rep();
+    const auto maxScale =
+          std::max({std::abs(scale.x), std::abs(scale.y), std::abs(scale.z)});
+    return {glm::vec3{transform.getModelMatrix() *
+                      glm::vec4{sphere.center, 1.f}},
+            sphere.radius * maxScale};
+}
+
+AABB transformed(const AABB& bounds, const glm::mat4& model) {
+    if (bounds.isEmpty()) {
+        return bounds;
+    }
+    // Arvo: each axis of the result is the translation plus, for every column
+    // of the matrix, whichever end of the box contributes least or most
+    AABB result{glm::vec3{model[3]}, glm::vec3{model[3]}};
+    for (int column = 0; column < 3; ++column) {
+        for (int row = 0; row < 3; ++row) {
+            const auto a = model[column][row] * bounds.min[column];
+            const auto b = model[column][row] * bounds.max[column];
+            result.min[row] += std::min(a, b);
+            result.max[row] += std::max(a, b);
+        }
+    }
+    return result;
+}
+
+float intersect(const Ray& ray, const AABB& bounds, float maxDistance) {
+    float near = 0.f, far = maxDistance;
+    for (int axis = 0; axis < 3; ++axis) {
+        const auto inverse = 1.f / ray.direction[axis];
+        auto t0 = (bounds.min[axis] - ray.origin[axis]) * inverse;
+        auto t1 = (bounds.max[axis] - ray.origin[axis]) * inverse;
+        if (t0 > t1) {
+            std::swap(t0, t1);
+        }
+        near = std::max(near, t0);
+        far = std::min(far, t1);
+        if (near > far) {
+            return -1.f;
+        }
+    }
+    return near;
+}
+
+//
+
+Frustum::Frustum(const glm::mat4& viewProjection) {
+    // Gribb & Hartmann: each plane is the last row of the matrix plus or minus
+    // one of the others
+    const auto m = glm::transpose(viewProjection);
+    planes = {{m[3] + m[0], m[3] - m[0], m[3] + m[1], m[3] - m[1],
+               m[3] + m[2], m[3] - m[2]}};
+    for (auto& plane : planes) {
+        plane /= glm::length(glm::vec3{plane});
+    }
+}
+
+bool Frustum::intersects(const BoundingSphere& sphere) const {
+    for (const auto& plane : planes) {
+        if (glm::dot(glm::vec3{plane}, sphere.center) + plane.w <
+            -sphere.radius) {
+            return false;
+        }
+    }
+    return true;
+}
+
+auto Frustum::classify(const AABB& bounds) const -> Containment {
+    auto result = Containment::Inside;
+    for (const auto& plane : planes) {
+        const glm::vec3 normal{plane};
+        // the corners furthest along and against the plane's normal
+        glm::vec3 positive, negative;
+        for (int axis = 0; axis < 3; ++axis) {
+            const auto along = normal[axis] >= 0.f;
+            positive[axis] = along ? bounds.max[axis] : bounds.min[axis];
+            negative[axis] = along ? bounds.min[axis] : bounds.max[axis];
+        }
+        if (glm::dot(normal, positive) + plane.w < 0.f) {
+            return Containment::Outside;
+        }
+        if (glm::dot(normal, negative) + plane.w < 0.f) {
+            result = Containment::Intersects;
+        }
+    }
+    return result;
+}
+
+NS_KEPLER_END
@@ -0,0 +1,104 @@
+#ifndef BOUNDS_HPP
+#define BOUNDS_HPP
+
+#include "common/types.hpp"
+#include "kepler_config.hpp"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+
+NS_KEPLER_BEGIN
+
+struct BoundingSphere {
+    glm::vec3 center;
+    float radius;
+};
+
+struct AABB {
+    glm::vec3 min{std::numeric_limits<float>::max()};
+    glm::vec3 max{std::numeric_limits<float>::lowest()};
+
+    template <typename Vertices>
+    static AABB fromVertices(const Vertices& vertices) {
+        AABB bounds;
+        for (const auto& vertex : vertices) {
+            bounds.min = glm::min(bounds.min, vertex.position.rep());
+            bounds.max = glm::max(bounds.max, vertex.position.rep());
+        }
+        return bounds;
+    }
+
+    bool isEmpty() const {
+        return min.x > max.x || min.y > max.y || min.z > max.z;
+    }
+
+    BoundingSphere getBoundingSphere() const {
+        if (isEmpty()) {
+            return {glm::vec3{0.f}, 0.f};
+        }
+        return {(min + max) * .5f, glm::length(max - min) * .5f};
+    }
+
+    float getSurfaceArea() const {
+        const auto d = max - min;
+        return 2.f * (d.x * d.y + d.y * d.z + d.z * d.x);
+    }
+
+    bool contains(const AABB& other) const {
+        return min.x <= other.min.x && min.y <= other.min.y &&
+               min.z <= other.min.z && max.x >= other.max.x &&
+               max.y >= other.max.y && max.z >= other.max.z;
+    }
+
+    bool intersects(const BoundingSphere& sphere) const {
+        const auto closest = glm::clamp(sphere.center, min, max);
+        const auto d = closest - sphere.center;
+        return glm::dot(d, d) <= sphere.radius * sphere.radius;
+    }
+
+    static AABB merged(const AABB& a, const AABB& b) {
+        return {glm::min(a.min, b.min), glm::max(a.max, b.max)};
+    }
+};
+
+// the bounds in world space of a model whose local bounds are given
+BoundingSphere transformed(const BoundingSphere& sphere,
+                           const Transform& transform);
+AABB transformed(const AABB& bounds, const glm::mat4& model);
+
+struct Ray {
+    glm::vec3 origin;
+    glm::vec3 direction;
+};
+
+// the distance along the ray at which it enters the box (0 if it starts
+// inside), or a negative number if it misses within maxDistance
+float intersect(const Ray& ray, const AABB& bounds, float maxDistance);
+
+class Frustum {
+   public:
+    // the planes of the clip volume, pulled back into whatever space the
+    // matrix transforms from (world space, for a view-projection)
+    explicit Frustum(const glm::mat4& viewProjection);
+
+    // normals point inwards, and are normalized so that plane distances are
+    // real distances
+    const std::array<glm::vec4, 6>& getPlanes() const { return planes; }
+
+    bool intersects(const BoundingSphere& sphere) const;
+
+    enum class Containment {
+        Outside,
+        Intersects,
+        Inside,
+    };
+    Containment classify(const AABB& bounds) const;
+
+   private:
+    std::array<glm::vec4, 6> planes;
+};
+
+NS_KEPLER_END
+
+#endif
@@ -13,6 +13,7 @@
 
 #include <ostream>
 #include <type_traits>
+#include <utility>
 
 NS_KEPLER_BEGIN
 
@@ -243,13 +244,24 @@ struct Transformed {
     Transformed(const Transform& t) : _transform{t} {}
     virtual ~Transformed() = default;
 
-    Transform& transform() { return _transform; }
+    // handing out a mutable transform counts as changing it
+    Transform& transform() {
+        transformChanged = true;
+        return _transform;
+    }
     const Transform& transform() const { return _transform; }
 
     glm::mat4 getModelMatrix() const { return transform().getModelMatrix(); }
 
+    // whether the transform may have changed since the last time this was
+    // called
+    bool checkTransformChanged() {
+        return std::exchange(transformChanged, false);
+    }
+
    private:
     Transform _transform;
+    bool transformChanged = true;
 };
 
 struct Seconds : Rep<float> {
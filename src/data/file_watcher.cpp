@@ -0,0 +1,138 @@
+#include "data/file_watcher.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#else
+#include <sys/stat.h>
+#include <chrono>
+#include <ctime>
+#endif
+
+NS_KEPLER_BEGIN
+
+namespace {
+void addOnce(std::vector<fs::AbsolutePath>& paths, const std::string& path) {
+    if (std::none_of(std::begin(paths), std::end(paths),
+                     [&](const fs::AbsolutePath& p) {
+                         return p.get() == path;
+                     })) {
+        paths.emplace_back(path);
+    }
+}
+}  // namespace
+
+#ifdef __linux__
+
+struct FileWatcher::Impl {
+    Impl() : fd{inotify_init1(IN_NONBLOCK | IN_CLOEXEC)} {}
+    ~Impl() {
+        if (fd != -1) {
+            close(fd);
+        }
+    }
+
+    void add(const std::string& file) {
+        if (fd == -1 || !files.insert(file).second) {
+            return;
+        }
+        const auto slash = file.rfind('/');
+        const auto directory =
+              slash == std::string::npos ? "./" : file.substr(0, slash + 1);
+        // a directory that's already watched gives back the same descriptor
+        const auto wd = inotify_add_watch(fd, directory.c_str(),
+                                          IN_CLOSE_WRITE | IN_MOVED_TO);
+        if (wd != -1) {
+            directories[wd] = slash == std::string::npos ? "" : directory;
+        }
+    }
+
+    std::vector<fs::AbsolutePath> poll() {
+        std::vector<fs::AbsolutePath> changed;
+        if (fd == -1) {
+            return changed;
+        }
+        alignas(inotify_event) char buffer[4096];
+        ssize_t length;
+        while ((length = read(fd, buffer, sizeof buffer)) > 0) {
+            for (auto p = buffer; p < buffer + length;) {
+                const auto event = reinterpret_cast<const inotify_event*>(p);
+                p += sizeof(inotify_event) + event->len;
+                const auto directory = directories.find(event->wd);
+                if (event->len == 0 || directory == std::end(directories)) {
+                    continue;
+                }
+                const auto path = directory->second + event->name;
+                if (files.count(path)) {
+                    addOnce(changed, path);
+                }
+            }
+        }
+        return changed;
+    }
+
+    int fd;
+    std::unordered_map<int, std::string> directories;
+    std::unordered_set<std::string> files;
+};
+
+#else
+
+struct FileWatcher::Impl {
+    void add(const std::string& file) {
+        if (!files.count(file)) {
+            files.emplace(file, modificationTime(file));
+        }
+    }
+
+    std::vector<fs::AbsolutePath> poll() {
+        std::vector<fs::AbsolutePath> changed;
+        const auto now = std::chrono::steady_clock::now();
+        if (now - lastCheck < std::chrono::milliseconds{500}) {
+            return changed;
+        }
+        lastCheck = now;
+        for (auto& file : files) {
+            const auto time = modificationTime(file.first);
+            if (time != file.second) {
+                file.second = time;
+                addOnce(changed, file.first);
+            }
+        }
+        return changed;
+    }
+
+    // 0 for a file that isn't there, like one being saved over
+    static std::time_t modificationTime(const std::string& file) {
+        struct stat info;
+        return stat(file.c_str(), &info) == 0 ? info.st_mtime : 0;
+    }
+
+    std::unordered_map<std::string, std::time_t> files;
+    std::chrono::steady_clock::time_point lastCheck;
+};
+
+#endif
+
+FileWatcher::FileWatcher() : impl{std::make_unique<Impl>()} {}
+FileWatcher::FileWatcher(FileWatcher&&) = default;
+FileWatcher& FileWatcher::operator=(FileWatcher&&) = default;
+FileWatcher::~FileWatcher() = default;
+
+void FileWatcher::add(const fs::AbsolutePath& file) {
+    assert(impl);
+    impl->add(file.get());
+}
+
+std::vector<fs::AbsolutePath> FileWatcher::poll() {
+    assert(impl);
+    return impl->poll();
+}
+
+NS_KEPLER_END
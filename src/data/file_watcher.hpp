@@ -0,0 +1,37 @@
+#ifndef FILE_WATCHER_HPP
+#define FILE_WATCHER_HPP
+
+#include "data/fs.hpp"
+#include "kepler_config.hpp"
+
+#include <memory>
+#include <vector>
+
+NS_KEPLER_BEGIN
+
+// tells which of a set of files have been written since it was last asked,
+// without ever waiting to find out. on linux, inotify watches the directories
+// the files are in, which also catches editors that save by renaming a new
+// file over the old one. elsewhere, the files' modification times are
+// compared, at most a couple of times a second.
+class FileWatcher {
+   public:
+    FileWatcher();
+    FileWatcher(FileWatcher&&);
+    FileWatcher& operator=(FileWatcher&&);
+    ~FileWatcher();
+
+    // does nothing for a file that's already watched
+    void add(const fs::AbsolutePath& file);
+
+    // each file once, however many times it was written
+    std::vector<fs::AbsolutePath> poll();
+
+   private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+};
+
+NS_KEPLER_END
+
+#endif
@@ -3,6 +3,7 @@
 #include "kepler_config.hpp"
 #include "util/util.hpp"
 
+#include <cassert>
 #include <fstream>
 #include <sstream>
 #include <string>
@@ -23,6 +24,8 @@ std::string absolutePathFromRelative(const std::string& rel) {
     path += rel;
     return path;
 }
+
+fs::LoadRecorder* recorder = nullptr;
 }  // namespace
 
 namespace fs {
@@ -36,8 +39,20 @@ std::string loadFileAsString(const AbsolutePath& path) {
     }
     std::stringstream buffer;
     buffer << t.rdbuf();
+    for (auto r = recorder; r; r = r->outer) {
+        r->paths.push_back(path);
+    }
     return buffer.str();
 }
+
+LoadRecorder::LoadRecorder() : outer{recorder} {
+    recorder = this;
+}
+
+LoadRecorder::~LoadRecorder() {
+    assert(recorder == this);
+    recorder = outer;
+}
 }  // namespace fs
 
 NS_KEPLER_END
@@ -6,6 +6,7 @@
 
 #include <exception>
 #include <string>
+#include <vector>
 
 NS_KEPLER_BEGIN
 
@@ -30,6 +31,21 @@ struct error_opening_file : std::runtime_error {
         : std::runtime_error{"couldn't open file \"" + name + "\""} {}
 };
 std::string loadFileAsString(const AbsolutePath& path);
+
+// notes the paths loadFileAsString loads while it's alive, including those an
+// inner recorder also notes
+class LoadRecorder : util::NonMovable {
+   public:
+    LoadRecorder();
+    ~LoadRecorder();
+
+    const std::vector<AbsolutePath>& getPaths() const { return paths; }
+
+   private:
+    friend std::string loadFileAsString(const AbsolutePath& path);
+    LoadRecorder* outer;
+    std::vector<AbsolutePath> paths;
+};
 }  // namespace fs
 
 NS_KEPLER_END
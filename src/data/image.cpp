@@ -1,6 +1,7 @@
 #include "data/image.hpp"
 #include "common/common.hpp"
 #include "data/fs.hpp"
+#include "util/trace.hpp"
 #include "util/util.hpp"
 
 #define STB_IMAGE_IMPLEMENTATION
@@ -30,13 +31,21 @@ struct Image::Impl : util::NonCopyable {
         : x{}
         , y{}
         , channels{}
-        , data{stbi_load(filename.c_str(), &x, &y, &channels, 0)} {
+        , data{load(filename, x, y, channels)} {
         if (data == nullptr) {
             throw fs::error_opening_file{filename};
         }
     }
     ~Impl() { stbi_image_free(data); }
 
+    static unsigned char* load(const std::string& filename,
+                               int& x,
+                               int& y,
+                               int& channels) {
+        trace::Scope trace{"load image"};
+        return stbi_load(filename.c_str(), &x, &y, &channels, 0);
+    }
+
     int x, y, channels;
     unsigned char* data;
 };
@@ -0,0 +1,210 @@
+#include "data/mesh_optimizer.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <utility>
+
+NS_KEPLER_BEGIN
+
+namespace mesh {
+namespace {
+struct BitwiseLess {
+    bool operator()(const Vertex& a, const Vertex& b) const {
+        return std::memcmp(&a, &b, sizeof(Vertex)) < 0;
+    }
+};
+
+// the tuning from Forsyth's article. the cache it models is LRU and bigger
+// than real hardware's, which works out well for FIFO caches too.
+constexpr std::size_t ModelledCacheSize = 32;
+constexpr float CacheDecayPower = 1.5f;
+constexpr float LastTriangleScore = 0.75f;
+constexpr float ValenceBoostScale = 2.f;
+constexpr float ValenceBoostPower = 0.5f;
+
+constexpr int NotCached = -1;
+constexpr auto NoTriangle = std::numeric_limits<std::size_t>::max();
+
+float vertexScore(int cachePosition, std::size_t remainingTriangles) {
+    if (remainingTriangles == 0) {
+        return -1.f;
+    }
+    float score = 0.f;
+    if (cachePosition != NotCached) {
+        if (cachePosition < 3) {
+            // the last triangle's vertices score the same on purpose, else
+            // the next triangle would always share an edge with it, and
+            // strips make poor use of the cache
+            score = LastTriangleScore;
+        } else {
+            const float scale = 1.f / (ModelledCacheSize - 3);
+            score = std::pow(1.f - (cachePosition - 3) * scale,
+                             CacheDecayPower);
+        }
+    }
+    // vertices with few triangles left get a boost, to finish them off
+    score += ValenceBoostScale *
+             std::pow(static_cast<float>(remainingTriangles),
+                      -ValenceBoostPower);
+    return score;
+}
+}  // namespace
+
+IndexedVertices weld(const Vertex* vertices, std::size_t count) {
+    IndexedVertices welded;
+    welded.indices.reserve(count);
+    std::map<Vertex, Index, BitwiseLess> seen;
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto inserted = seen.emplace(
+              vertices[i], static_cast<Index>(welded.vertices.size()));
+        if (inserted.second) {
+            welded.vertices.push_back(vertices[i]);
+        }
+        welded.indices.push_back(inserted.first->second);
+    }
+    return welded;
+}
+
+void optimizeVertexCache(std::vector<Index>& indices, std::size_t vertexCount) {
+    assert(indices.size() % 3 == 0);
+    const auto triangleCount = indices.size() / 3;
+
+    // the triangles using each vertex, in one array. each vertex's live
+    // triangles are kept at the front of its range.
+    std::vector<std::size_t> remaining(vertexCount, 0);
+    for (const auto index : indices) {
+        ++remaining[index];
+    }
+    std::vector<std::size_t> offsets(vertexCount + 1, 0);
+    for (std::size_t v = 0; v < vertexCount; ++v) {
+        offsets[v + 1] = offsets[v] + remaining[v];
+    }
+    std::vector<std::size_t> adjacency(indices.size());
+    {
+        auto fill = offsets;
+        for (std::size_t t = 0; t < triangleCount; ++t) {
+            for (std::size_t k = 0; k < 3; ++k) {
+                adjacency[fill[indices[3 * t + k]]++] = t;
+            }
+        }
+    }
+
+    std::vector<int> cachePosition(vertexCount, NotCached);
+    std::vector<float> scores(vertexCount);
+    for (std::size_t v = 0; v < vertexCount; ++v) {
+        scores[v] = vertexScore(NotCached, remaining[v]);
+    }
+    const auto triangleScore = [&](std::size_t t) {
+        return scores[indices[3 * t]] + scores[indices[3 * t + 1]] +
+               scores[indices[3 * t + 2]];
+    };
+    std::vector<bool> added(triangleCount, false);
+
+    std::vector<Index> reordered;
+    reordered.reserve(indices.size());
+    std::vector<Index> cache, nextCache;
+    std::size_t best = NoTriangle;
+    float bestScore = -1.f;
+    for (std::size_t t = 0; t < triangleCount; ++t) {
+        const auto score = triangleScore(t);
+        if (score > bestScore) {
+            best = t;
+            bestScore = score;
+        }
+    }
+    std::size_t nextUnadded = 0;
+
+    while (reordered.size() < indices.size()) {
+        if (best == NoTriangle) {
+            // nothing in the cache has triangles left, so start somewhere new
+            while (added[nextUnadded]) {
+                ++nextUnadded;
+            }
+            best = nextUnadded;
+        }
+        added[best] = true;
+        const Index* const triangle = &indices[3 * best];
+        reordered.insert(std::end(reordered), triangle, triangle + 3);
+
+        nextCache.assign(triangle, triangle + 3);
+        for (const auto v : cache) {
+            if (std::find(triangle, triangle + 3, v) == triangle + 3) {
+                nextCache.push_back(v);
+            }
+        }
+        for (std::size_t k = 0; k < 3; ++k) {
+            const auto v = triangle[k];
+            const auto first = std::begin(adjacency) + offsets[v];
+            const auto last = first + remaining[v];
+            std::iter_swap(std::find(first, last, best), last - 1);
+            --remaining[v];
+        }
+        for (std::size_t i = 0; i < nextCache.size(); ++i) {
+            const auto v = nextCache[i];
+            cachePosition[v] =
+                  i < ModelledCacheSize ? static_cast<int>(i) : NotCached;
+            scores[v] = vertexScore(cachePosition[v], remaining[v]);
+        }
+        if (nextCache.size() > ModelledCacheSize) {
+            nextCache.resize(ModelledCacheSize);
+        }
+        std::swap(cache, nextCache);
+
+        // only triangles touching the cache can have changed score
+        best = NoTriangle;
+        bestScore = -1.f;
+        for (const auto v : cache) {
+            for (std::size_t i = 0; i < remaining[v]; ++i) {
+                const auto t = adjacency[offsets[v] + i];
+                const auto score = triangleScore(t);
+                if (score > bestScore) {
+                    best = t;
+                    bestScore = score;
+                }
+            }
+        }
+    }
+    indices = std::move(reordered);
+}
+
+void optimizeVertexFetch(IndexedVertices& mesh) {
+    constexpr auto Unused = std::numeric_limits<Index>::max();
+    std::vector<Index> remap(mesh.vertices.size(), Unused);
+    std::vector<Vertex> reordered;
+    reordered.reserve(mesh.vertices.size());
+    for (auto& index : mesh.indices) {
+        if (remap[index] == Unused) {
+            remap[index] = static_cast<Index>(reordered.size());
+            reordered.push_back(mesh.vertices[index]);
+        }
+        index = remap[index];
+    }
+    mesh.vertices = std::move(reordered);
+}
+
+float computeACMR(const std::vector<Index>& indices,
+                  std::size_t vertexCount,
+                  std::size_t cacheSize) {
+    if (indices.empty()) {
+        return 0.f;
+    }
+    // a vertex is still cached if fewer than cacheSize vertices have been
+    // transformed since it was
+    std::vector<std::size_t> transformedAt(vertexCount, 0);
+    std::size_t time = cacheSize + 1;
+    std::size_t misses = 0;
+    for (const auto index : indices) {
+        if (time - transformedAt[index] > cacheSize) {
+            transformedAt[index] = time++;
+            ++misses;
+        }
+    }
+    return static_cast<float>(misses) / (indices.size() / 3);
+}
+}  // namespace mesh
+
+NS_KEPLER_END
@@ -0,0 +1,42 @@
+#ifndef MESH_OPTIMIZER_HPP
+#define MESH_OPTIMIZER_HPP
+
+#include "common/types.hpp"
+#include "kepler_config.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+NS_KEPLER_BEGIN
+
+// preprocessing for triangle lists, meant to run once when a mesh is loaded
+namespace mesh {
+using Index = std::uint32_t;
+
+struct IndexedVertices {
+    std::vector<Vertex> vertices;
+    std::vector<Index> indices;
+};
+
+// merges bitwise identical vertices, keeping them in order of first use
+IndexedVertices weld(const Vertex* vertices, std::size_t count);
+
+// reorders triangles so that consecutive ones reuse recently transformed
+// vertices (Tom Forsyth's "Linear-Speed Vertex Cache Optimisation")
+void optimizeVertexCache(std::vector<Index>& indices, std::size_t vertexCount);
+
+// reorders vertices into the order the indices first use them, so that
+// fetching them walks through memory in order
+void optimizeVertexFetch(IndexedVertices& mesh);
+
+// average cache miss ratio: vertices transformed per triangle, simulating a
+// FIFO post-transform cache. 3 is the worst possible, 0.5 the best.
+float computeACMR(const std::vector<Index>& indices,
+                  std::size_t vertexCount,
+                  std::size_t cacheSize = 16);
+}  // namespace mesh
+
+NS_KEPLER_END
+
+#endif
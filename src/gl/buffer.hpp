@@ -8,6 +8,8 @@
 #include "gl/gl_object.hpp"
 
 #include <array>
+#include <cstddef>
+#include <type_traits>
 #include <vector>
 
 NS_KEPLER_BEGIN
@@ -15,12 +17,16 @@ NS_KEPLER_BEGIN
 namespace detail {
 template <GLenum Target>
 struct BindBuffer {
-    static void bind(GLuint buf) noexcept { glBindBuffer(Target, buf); }
+    static void bind(GLuint buf) noexcept {
+        GL::state::bindBuffer(Target, buf);
+    }
+    static GLuint current() noexcept { return GL::state::getBuffer(Target); }
 };
 struct DeleteBuffer {
     void operator()(GLuint buf) const noexcept {
         assert(glIsBuffer(buf));
         glDeleteBuffers(1, &buf);
+        GL::state::bufferDeleted(buf);
     }
 };
 }  // namespace detail
@@ -54,14 +60,37 @@ struct VertexAttributeBuffer final : public VertexAttributeBuffer_base {
     std::size_t getElementCount() const noexcept { return elementCount; }
 
     template <typename ContiguousData>
-    void setData(const ContiguousData& data) {
-        _setData(data.size(), data.data());
+    void setData(const ContiguousData& data, GLenum usage = GL_STATIC_DRAW) {
+        _setData(data.size(), data.data(), usage);
+    }
+    void setData(const T* data,
+                 std::size_t count,
+                 GLenum usage = GL_STATIC_DRAW) {
+        _setData(count, data, usage);
+    }
+
+    // overwrites elements [offset, offset + count) without reallocating
+    void updateData(std::size_t offset, std::size_t count, const T* data) {
+        assert(offset + count <= elementCount);
+        RAIIBinding<VertexAttributeBuffer> binding{*this};
+        GL_CHECK(glBufferSubData(target, offset * sizeof(T), count * sizeof(T),
+                                 data));
+    }
+
+    // reads the contents back from the GL, which waits for anything still
+    // writing to the buffer
+    std::vector<T> readData() {
+        std::vector<T> data(elementCount);
+        RAIIBinding<VertexAttributeBuffer> binding{*this};
+        GL_CHECK(glGetBufferSubData(target, 0, elementCount * sizeof(T),
+                                    data.data()));
+        return data;
     }
 
    private:
-    void _setData(std::size_t count, const T* data) {
+    void _setData(std::size_t count, const T* data, GLenum usage) {
         RAIIBinding<VertexAttributeBuffer> binding{*this};
-        GL_CHECK(glBufferData(target, count * sizeof(T), data, GL_STATIC_DRAW));
+        GL_CHECK(glBufferData(target, count * sizeof(T), data, usage));
         this->elementCount = count;
     }
     std::size_t elementCount;
@@ -69,6 +98,64 @@ struct VertexAttributeBuffer final : public VertexAttributeBuffer_base {
 
 using VertexBuffer = VertexAttributeBuffer<Vertex>;
 
+// the element array binding belongs to the bound VAO, so an index buffer is
+// only bound by attaching it to one (see VertexArrayObject). its data goes
+// through GL_COPY_WRITE_BUFFER instead, which leaves the bound VAO alone.
+struct IndexBuffer final : public Buffer_base<GL_ELEMENT_ARRAY_BUFFER> {
+    using Index = GLuint;
+
+    IndexBuffer() : elementCount{0} {}
+    template <typename ContiguousData>
+    IndexBuffer(const ContiguousData& data) : IndexBuffer{} {
+        setData(data);
+    }
+    std::size_t getElementCount() const noexcept { return elementCount; }
+    GLenum getIndexType() const noexcept { return GL_UNSIGNED_INT; }
+
+    template <typename ContiguousData>
+    void setData(const ContiguousData& data, GLenum usage = GL_STATIC_DRAW) {
+        static_assert(sizeof(*data.data()) == sizeof(Index), "");
+        GL::state::bindBuffer(GL_COPY_WRITE_BUFFER, getHandle());
+        GL_CHECK(glBufferData(GL_COPY_WRITE_BUFFER, data.size() * sizeof(Index),
+                              data.data(), usage));
+        this->elementCount = data.size();
+    }
+
+    // room for count indices, left undefined
+    void allocate(std::size_t count, GLenum usage = GL_STATIC_DRAW) {
+        GL::state::bindBuffer(GL_COPY_WRITE_BUFFER, getHandle());
+        GL_CHECK(glBufferData(GL_COPY_WRITE_BUFFER, count * sizeof(Index),
+                              nullptr, usage));
+        this->elementCount = count;
+    }
+
+    std::vector<Index> readData() {
+        std::vector<Index> data(elementCount);
+        GL::state::bindBuffer(GL_COPY_WRITE_BUFFER, getHandle());
+        GL_CHECK(glGetBufferSubData(GL_COPY_WRITE_BUFFER, 0,
+                                    elementCount * sizeof(Index), data.data()));
+        return data;
+    }
+
+   private:
+    std::size_t elementCount;
+};
+
+// helpers for mirroring std140 uniform blocks in C++. scalars are aligned to
+// their own size, but vec3s, vec4s, matrix columns, structs and array elements
+// are all aligned to 16 bytes. so a vec3 member needs
+// alignas(std140::vec4Alignment), though a scalar can still be packed into the
+// four bytes after it.
+namespace std140 {
+constexpr std::size_t vec4Alignment = 16;
+
+template <typename Block>
+struct is_block
+    : std::integral_constant<bool,
+                             std::is_standard_layout<Block>::value &&
+                                   sizeof(Block) % vec4Alignment == 0> {};
+}  // namespace std140
+
 NS_KEPLER_END
 
 #endif
@@ -0,0 +1,178 @@
+#include "gl/extensions.hpp"
+#include "gl/gl.hpp"
+
+#include <cassert>
+#include <cstring>
+
+NS_KEPLER_BEGIN
+
+namespace {
+using BufferStorageProc = void(APIENTRYP)(GLenum target,
+                                          GLsizeiptr size,
+                                          const void* data,
+                                          GLbitfield flags);
+BufferStorageProc bufferStorageProc = nullptr;
+using MultiDrawElementsIndirectProc = void(APIENTRYP)(GLenum mode,
+                                                      GLenum type,
+                                                      const void* indirect,
+                                                      GLsizei drawCount,
+                                                      GLsizei stride);
+MultiDrawElementsIndirectProc multiDrawElementsIndirectProc = nullptr;
+using ProgramParameteriProc = void(APIENTRYP)(GLuint program,
+                                              GLenum pname,
+                                              GLint value);
+ProgramParameteriProc programParameteriProc = nullptr;
+using GetProgramBinaryProc = void(APIENTRYP)(GLuint program,
+                                             GLsizei bufSize,
+                                             GLsizei* length,
+                                             GLenum* binaryFormat,
+                                             void* binary);
+GetProgramBinaryProc getProgramBinaryProc = nullptr;
+using ProgramBinaryProc = void(APIENTRYP)(GLuint program,
+                                          GLenum binaryFormat,
+                                          const void* binary,
+                                          GLsizei length);
+ProgramBinaryProc programBinaryProc = nullptr;
+bool parallelShaderCompile = false;
+using MaxShaderCompilerThreadsProc = void(APIENTRYP)(GLuint count);
+
+bool isSupported(const char* extension) {
+    GLint count = 0;
+    GL_CHECK(glGetIntegerv(GL_NUM_EXTENSIONS, &count));
+    for (GLint i = 0; i < count; ++i) {
+        const auto name = reinterpret_cast<const char*>(
+              glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+        if (name && std::strcmp(name, extension) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool isCoreSince(GLint major, GLint minor) {
+    GLint contextMajor = 0, contextMinor = 0;
+    GL_CHECK(glGetIntegerv(GL_MAJOR_VERSION, &contextMajor));
+    GL_CHECK(glGetIntegerv(GL_MINOR_VERSION, &contextMinor));
+    return contextMajor > major ||
+           (contextMajor == major && contextMinor >= minor);
+}
+}  // namespace
+
+namespace GL {
+namespace extensions {
+void load(GLADloadproc loader) {
+    bufferStorageProc = nullptr;
+    if (isCoreSince(4, 4) || isSupported("GL_ARB_buffer_storage")) {
+        bufferStorageProc =
+              reinterpret_cast<BufferStorageProc>(loader("glBufferStorage"));
+    }
+
+    multiDrawElementsIndirectProc = nullptr;
+#ifdef KEPLER_GL_HAS_MULTI_DRAW_INDIRECT
+    const bool multiDrawIndirect = true;
+#else
+    // a base instance other than 0 needs ARB_base_instance
+    const bool multiDrawIndirect =
+          isCoreSince(4, 3) || (isSupported("GL_ARB_multi_draw_indirect") &&
+                                isSupported("GL_ARB_base_instance"));
+#endif
+    if (multiDrawIndirect) {
+        multiDrawElementsIndirectProc =
+              reinterpret_cast<MultiDrawElementsIndirectProc>(
+                    loader("glMultiDrawElementsIndirect"));
+    }
+
+    programParameteriProc = nullptr;
+    getProgramBinaryProc = nullptr;
+    programBinaryProc = nullptr;
+    if (isCoreSince(4, 1) || isSupported("GL_ARB_get_program_binary")) {
+        GLint formats = 0;
+        GL_CHECK(glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats));
+        if (formats > 0) {
+            programParameteriProc = reinterpret_cast<ProgramParameteriProc>(
+                  loader("glProgramParameteri"));
+            getProgramBinaryProc = reinterpret_cast<GetProgramBinaryProc>(
+                  loader("glGetProgramBinary"));
+            programBinaryProc = reinterpret_cast<ProgramBinaryProc>(
+                  loader("glProgramBinary"));
+        }
+    }
+
+    parallelShaderCompile = false;
+    MaxShaderCompilerThreadsProc maxShaderCompilerThreads = nullptr;
+    if (isSupported("GL_KHR_parallel_shader_compile")) {
+        maxShaderCompilerThreads =
+              reinterpret_cast<MaxShaderCompilerThreadsProc>(
+                    loader("glMaxShaderCompilerThreadsKHR"));
+    } else if (isSupported("GL_ARB_parallel_shader_compile")) {
+        maxShaderCompilerThreads =
+              reinterpret_cast<MaxShaderCompilerThreadsProc>(
+                    loader("glMaxShaderCompilerThreadsARB"));
+    }
+    if (maxShaderCompilerThreads) {
+        // as many as the driver sees fit
+        GL_CHECK(maxShaderCompilerThreads(0xFFFFFFFF));
+        parallelShaderCompile = true;
+    }
+}
+
+bool hasBufferStorage() {
+    return bufferStorageProc != nullptr;
+}
+
+void bufferStorage(GLenum target,
+                   GLsizeiptr size,
+                   const void* data,
+                   GLbitfield flags) {
+    assert(hasBufferStorage());
+    bufferStorageProc(target, size, data, flags);
+}
+
+bool hasMultiDrawIndirect() {
+    return multiDrawElementsIndirectProc != nullptr;
+}
+
+void multiDrawElementsIndirect(GLenum mode,
+                               GLenum type,
+                               std::size_t offset,
+                               GLsizei drawCount) {
+    assert(hasMultiDrawIndirect());
+    multiDrawElementsIndirectProc(mode, type,
+                                  reinterpret_cast<const void*>(offset),
+                                  drawCount, 0);
+}
+
+bool hasProgramBinary() {
+    return programParameteriProc != nullptr &&
+           getProgramBinaryProc != nullptr && programBinaryProc != nullptr;
+}
+
+void programParameteri(GLuint program, GLenum pname, GLint value) {
+    assert(hasProgramBinary());
+    programParameteriProc(program, pname, value);
+}
+
+void getProgramBinary(GLuint program,
+                      GLsizei bufSize,
+                      GLsizei* length,
+                      GLenum* binaryFormat,
+                      void* binary) {
+    assert(hasProgramBinary());
+    getProgramBinaryProc(program, bufSize, length, binaryFormat, binary);
+}
+
+void programBinary(GLuint program,
+                   GLenum binaryFormat,
+                   const void* binary,
+                   GLsizei length) {
+    assert(hasProgramBinary());
+    programBinaryProc(program, binaryFormat, binary, length);
+}
+
+bool hasParallelShaderCompile() {
+    return parallelShaderCompile;
+}
+}  // namespace extensions
+}  // namespace GL
+
+NS_KEPLER_END
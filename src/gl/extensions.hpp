@@ -0,0 +1,89 @@
+#ifndef EXTENSIONS_HPP
+#define EXTENSIONS_HPP
+
+#include "kepler_config.hpp"
+
+#include <glad/glad.h>
+
+#include <cstddef>
+
+// from ARB_buffer_storage, which the 3.3 core loader doesn't know about
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#define GL_MAP_COHERENT_BIT 0x0080
+#define GL_DYNAMIC_STORAGE_BIT 0x0100
+#define GL_CLIENT_STORAGE_BIT 0x0200
+#endif
+// from ARB_draw_indirect
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+// from ARB_get_program_binary
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+// from KHR_parallel_shader_compile
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+NS_KEPLER_BEGIN
+
+namespace GL {
+// entry points from past the 3.3 core, for when the context happens to have
+// them. nothing is available until load has been called.
+namespace extensions {
+// call once glad is loaded, with the same function glad loaded from
+void load(GLADloadproc loader);
+
+// persistently mapped buffers
+bool hasBufferStorage();
+void bufferStorage(GLenum target,
+                   GLsizeiptr size,
+                   const void* data,
+                   GLbitfield flags);
+
+// drawing a whole list of indexed meshes with one call. per-instance
+// attributes of each draw start at its baseInstance, which is what tells the
+// draws apart in the shader.
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+bool hasMultiDrawIndirect();
+// the commands are read from the buffer bound to GL_DRAW_INDIRECT_BUFFER,
+// starting at the given offset
+void multiDrawElementsIndirect(GLenum mode,
+                               GLenum type,
+                               std::size_t offset,
+                               GLsizei drawCount);
+
+// saving a linked program and loading it back later, by the same driver. also
+// false if the driver has no binary formats to save them in.
+bool hasProgramBinary();
+void programParameteri(GLuint program, GLenum pname, GLint value);
+void getProgramBinary(GLuint program,
+                      GLsizei bufSize,
+                      GLsizei* length,
+                      GLenum* binaryFormat,
+                      void* binary);
+void programBinary(GLuint program,
+                   GLenum binaryFormat,
+                   const void* binary,
+                   GLsizei length);
+
+// compiling and linking on the driver's own threads. with it, a shader's or
+// program's GL_COMPLETION_STATUS_KHR can be asked for without waiting on it.
+// load lets the driver use as many threads as it likes.
+bool hasParallelShaderCompile();
+}  // namespace extensions
+}  // namespace GL
+
+NS_KEPLER_END
+
+#endif
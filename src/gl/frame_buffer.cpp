@@ -78,8 +78,8 @@ GLenum getFilter(GLbitfield mask) {
 void FrameBuffer::blit(GLbitfield mask,
                        View destination,
                        Resolution resolution) {
-    GL_CHECK(glBindFramebuffer(GL_READ_FRAMEBUFFER, this->getHandle()));
-    GL_CHECK(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, destination.fbo));
+    GL::state::bindFramebuffer(GL_READ_FRAMEBUFFER, this->getHandle());
+    GL::state::bindFramebuffer(GL_DRAW_FRAMEBUFFER, destination.fbo);
     GL_CHECK(glBlitFramebuffer(0, 0, resolution.width(), resolution.height(), 0,
                                0, resolution.width(), resolution.height(), mask,
                                getFilter(mask)));
@@ -15,13 +15,17 @@ NS_KEPLER_BEGIN
 namespace detail {
 struct BindFBO {
     static void bind(GLuint buf) noexcept {
-        glBindFramebuffer(GL_FRAMEBUFFER, buf);
+        GL::state::bindFramebuffer(GL_FRAMEBUFFER, buf);
+    }
+    static GLuint current() noexcept {
+        return GL::state::getFramebuffer(GL_FRAMEBUFFER);
     }
 };
 struct DeleteFBO {
     void operator()(GLuint fbo) const {
         assert(glIsFramebuffer(fbo));
         glDeleteFramebuffers(1, &fbo);
+        GL::state::framebufferDeleted(fbo);
     }
 };
 }  // namespace detail
@@ -34,12 +38,7 @@ class FrameBuffer : public GLObject<detail::BindFBO, detail::DeleteFBO> {
         View& operator=(const View&) = default;
         GLuint fbo;
 
-        void bind() noexcept {
-            if (this->fbo != FrameBuffer::currentlyBound) {
-                GL_CHECK(detail::BindFBO::bind(this->fbo));
-                currentlyBound = this->fbo;
-            }
-        }
+        void bind() noexcept { GL_CHECK(detail::BindFBO::bind(this->fbo)); }
         static void unbind() noexcept {}
     };
     operator View() const { return View{getHandle()}; }
@@ -1,6 +1,7 @@
 #ifndef GL_HPP
 #define GL_HPP
 
+#include "gl/state.hpp"
 #include "kepler_config.hpp"
 
 #include <glad/glad.h>
@@ -43,8 +44,8 @@ namespace GL {
 namespace detail {
 template <GLenum Enum>
 struct EnableDisable {
-    static void enable() { GL_CHECK(glEnable(Enum)); }
-    static void disable() { GL_CHECK(glDisable(Enum)); }
+    static void enable() { state::setEnabled(Enum, true); }
+    static void disable() { state::setEnabled(Enum, false); }
 };
 }  // namespace detail
 
@@ -54,20 +55,16 @@ using FaceCulling = detail::EnableDisable<GL_CULL_FACE>;
 using Blending = detail::EnableDisable<GL_BLEND>;
 
 struct DepthWrite {
-    static void enable() { GL_CHECK(glDepthMask(GL_TRUE)); }
-    static void disable() { GL_CHECK(glDepthMask(GL_FALSE)); }
+    static void enable() { state::depthMask(true); }
+    static void disable() { state::depthMask(false); }
 };
 struct StencilWrite {
-    static void enable() { GL_CHECK(glStencilMask(0xFF)); }
-    static void disable() { GL_CHECK(glStencilMask(0x00)); }
+    static void enable() { state::stencilMask(0xFF); }
+    static void disable() { state::stencilMask(0x00); }
 };
 struct ColorWrite {
-    static void enable() {
-        GL_CHECK(glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE));
-    }
-    static void disable() {
-        GL_CHECK(glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE));
-    }
+    static void enable() { state::colorMask(true); }
+    static void disable() { state::colorMask(false); }
 };
 
 template <typename T>
@@ -21,26 +21,17 @@ struct GLObject_bind {};
 template <typename Binder, typename GLObject>
 struct GLObject_bind<Binder, GLObject, true> {
    public:
+    // redundant binds are filtered out by GL::state
     void bind() noexcept(noexcept(Binder::bind(detail::handle()))) {
-        const auto handle = static_cast<GLObject*>(this)->getHandle();
-        if (handle != currentlyBound) {
-            GL_CHECK(Binder::bind(handle));
-            currentlyBound = handle;
-        }
+        GL_CHECK(Binder::bind(static_cast<GLObject*>(this)->getHandle()));
     }
     void unbind() noexcept(noexcept(Binder::bind(detail::handle()))) {
         const auto handle = static_cast<GLObject*>(this)->getHandle();
-        if (handle == currentlyBound) {
+        if (handle == Binder::current()) {
             GL_CHECK(Binder::bind(0));
-            currentlyBound = 0;
         }
     }
-
-   protected:
-    static GLuint currentlyBound;
 };
-template <typename Object, typename GLObject>
-GLuint GLObject_bind<Object, GLObject, true>::currentlyBound = 0;
 
 }  // namespace detail
 
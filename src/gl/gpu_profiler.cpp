@@ -0,0 +1,288 @@
+#include "gl/gpu_profiler.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <numeric>
+#include <utility>
+
+NS_KEPLER_BEGIN
+
+namespace {
+// frames of history each pass keeps
+std::size_t historySize = 300;
+constexpr std::size_t noParent = static_cast<std::size_t>(-1);
+
+struct Pass {
+    std::string path;
+    std::size_t parent;
+    std::size_t depth;
+    std::deque<float> history;
+};
+std::vector<Pass> passes;
+std::map<std::pair<std::size_t, std::string>, std::size_t> passIndices;
+
+// a scope's timestamps, by their index into the frame's queries
+struct Sample {
+    std::size_t pass;
+    std::size_t begin;
+    std::size_t end;
+};
+struct Frame {
+    std::vector<GLuint> queries;
+    std::size_t usedQueries = 0;
+    std::vector<Sample> samples;
+};
+// the frame being recorded, the ones waiting on their results (oldest
+// first), and finished ones kept to reuse, queries and all
+Frame current;
+std::deque<Frame> pending;
+std::vector<Frame> spares;
+bool inFrame = false;
+// indices into the current frame's samples
+std::vector<std::size_t> openSamples;
+std::size_t framesTimed = 0;
+std::size_t framesDropped = 0;
+
+std::size_t getPass(std::size_t parent, const std::string& name) {
+    auto key = std::make_pair(parent, name);
+    auto it = passIndices.find(key);
+    if (it != std::end(passIndices)) {
+        return it->second;
+    }
+    if (parent == noParent) {
+        passes.push_back({name, parent, 0, {}});
+    } else {
+        passes.push_back({passes[parent].path + '/' + name, parent,
+                          passes[parent].depth + 1, {}});
+    }
+    passIndices.emplace(std::move(key), passes.size() - 1);
+    return passes.size() - 1;
+}
+
+std::size_t timestamp(Frame& frame) {
+    if (frame.usedQueries == frame.queries.size()) {
+        GLuint query;
+        glGenQueries(1, &query);
+        frame.queries.push_back(query);
+    }
+    GL_CHECK(glQueryCounter(frame.queries[frame.usedQueries], GL_TIMESTAMP));
+    return frame.usedQueries++;
+}
+
+void openScope(const std::string& name) {
+    const auto parent = openSamples.empty()
+                              ? noParent
+                              : current.samples[openSamples.back()].pass;
+    current.samples.push_back({getPass(parent, name), timestamp(current), 0});
+    openSamples.push_back(current.samples.size() - 1);
+}
+
+void closeScope() {
+    assert(!openSamples.empty());
+    current.samples[openSamples.back()].end = timestamp(current);
+    openSamples.pop_back();
+}
+
+GLuint64 getResult(const Frame& frame, std::size_t query) {
+    GLuint64 result;
+    glGetQueryObjectui64v(frame.queries[query], GL_QUERY_RESULT, &result);
+    return result;
+}
+
+bool isReady(const Frame& frame) {
+    // the GPU gets to the timestamps in order, so the last one being ready
+    // means they all are
+    GLint available = GL_FALSE;
+    glGetQueryObjectiv(frame.queries[frame.usedQueries - 1],
+                       GL_QUERY_RESULT_AVAILABLE, &available);
+    return available;
+}
+
+void record(const Frame& frame) {
+    // a pass that ran more than once in the frame counts once, in total
+    std::map<std::size_t, float> totals;
+    for (const auto& sample : frame.samples) {
+        const auto nanoseconds =
+              getResult(frame, sample.end) - getResult(frame, sample.begin);
+        totals[sample.pass] += nanoseconds / 1e6f;
+    }
+    for (const auto& total : totals) {
+        auto& history = passes[total.first].history;
+        history.push_back(total.second);
+        if (history.size() > historySize) {
+            history.pop_front();
+        }
+    }
+    ++framesTimed;
+}
+
+void retireOldest() {
+    auto& frame = pending.front();
+    frame.samples.clear();
+    frame.usedQueries = 0;
+    spares.push_back(std::move(frame));
+    pending.pop_front();
+}
+
+// frames finish in order, so this stops at the first one that hasn't
+void collect(bool wait) {
+    while (!pending.empty() && (wait || isReady(pending.front()))) {
+        record(pending.front());
+        retireOldest();
+    }
+    GL_CHECK();
+}
+
+void deleteQueries(Frame& frame) {
+    if (!frame.queries.empty()) {
+        glDeleteQueries(frame.queries.size(), frame.queries.data());
+    }
+}
+
+// nearest rank
+float percentile(const std::vector<float>& sorted, float p) {
+    const auto rank = static_cast<std::size_t>(std::ceil(p * sorted.size()));
+    return sorted[std::max<std::size_t>(rank, 1) - 1];
+}
+
+void addStats(std::size_t pass,
+              const std::vector<std::vector<std::size_t>>& children,
+              std::vector<GPUProfiler::PassStats>& stats) {
+    const auto& history = passes[pass].history;
+    if (!history.empty()) {
+        std::vector<float> sorted{std::begin(history), std::end(history)};
+        std::sort(std::begin(sorted), std::end(sorted));
+        const auto sum =
+              std::accumulate(std::begin(sorted), std::end(sorted), 0.f);
+        stats.push_back({passes[pass].path, passes[pass].depth, sorted.size(),
+                         sum / sorted.size(), percentile(sorted, .5f),
+                         percentile(sorted, .95f), percentile(sorted, .99f),
+                         sorted.back()});
+    }
+    for (const auto child : children[pass]) {
+        addStats(child, children, stats);
+    }
+}
+}  // namespace
+
+namespace GPUProfiler {
+void beginFrame() {
+    assert(!inFrame);
+    collect(false);
+    if (spares.empty()) {
+        current = Frame{};
+    } else {
+        current = std::move(spares.back());
+        spares.pop_back();
+    }
+    inFrame = true;
+    openScope("frame");
+}
+
+void endFrame() {
+    assert(inFrame);
+    closeScope();
+    assert(openSamples.empty() && "a scope outlived the frame");
+    inFrame = false;
+    pending.push_back(std::move(current));
+    if (pending.size() > MaxFramesPending) {
+        // the GPU is hopelessly behind, or its results are never coming
+        retireOldest();
+        ++framesDropped;
+    }
+}
+
+Scope::Scope(const std::string& name) : open{inFrame} {
+    if (open) {
+        openScope(name);
+    }
+}
+
+Scope::~Scope() {
+    if (open) {
+        closeScope();
+    }
+}
+
+Stats getStats() {
+    std::vector<std::vector<std::size_t>> children(passes.size());
+    std::vector<std::size_t> roots;
+    for (std::size_t i = 0; i < passes.size(); ++i) {
+        if (passes[i].parent == noParent) {
+            roots.push_back(i);
+        } else {
+            children[passes[i].parent].push_back(i);
+        }
+    }
+    Stats stats;
+    for (const auto root : roots) {
+        addStats(root, children, stats.passes);
+    }
+    stats.framesTimed = framesTimed;
+    stats.framesDropped = framesDropped;
+    return stats;
+}
+
+void flush() {
+    assert(!inFrame);
+    collect(true);
+}
+
+void writeReport(const fs::AbsolutePath& path) {
+    std::ofstream file{path.get()};
+    if (!file) {
+        throw fs::error_opening_file{path.get()};
+    }
+    const auto stats = getStats();
+    file << "gpu time per pass in ms, over the last " << historySize
+         << " frames (" << stats.framesTimed << " frames timed, "
+         << stats.framesDropped << " dropped)\n";
+    file << std::left << std::setw(32) << "pass" << std::right;
+    for (const auto column : {"average", "median", "p95", "p99", "max"}) {
+        file << std::setw(10) << column;
+    }
+    file << std::setw(10) << "samples" << '\n' << std::fixed;
+    for (const auto& pass : stats.passes) {
+        const auto name = pass.path.substr(pass.path.rfind('/') + 1);
+        file << std::left << std::setw(32)
+             << std::string(pass.depth * 2, ' ') + name << std::right
+             << std::setprecision(3);
+        for (const auto value :
+             {pass.average, pass.median, pass.p95, pass.p99, pass.max}) {
+            file << std::setw(10) << value;
+        }
+        file << std::setw(10) << pass.samples << '\n';
+    }
+}
+
+void setHistorySize(std::size_t frames) {
+    historySize = std::max<std::size_t>(frames, 1);
+    for (auto& pass : passes) {
+        while (pass.history.size() > historySize) {
+            pass.history.pop_front();
+        }
+    }
+}
+
+void clear() {
+    assert(!inFrame);
+    for (auto& frame : pending) {
+        deleteQueries(frame);
+    }
+    pending.clear();
+    for (auto& frame : spares) {
+        deleteQueries(frame);
+    }
+    spares.clear();
+    passes.clear();
+    passIndices.clear();
+    framesTimed = framesDropped = 0;
+}
+}  // namespace GPUProfiler
+
+NS_KEPLER_END
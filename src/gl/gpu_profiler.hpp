@@ -0,0 +1,80 @@
+#ifndef GPU_PROFILER_HPP
+#define GPU_PROFILER_HPP
+
+#include "common/common.hpp"
+#include "data/fs.hpp"
+#include "gl/gl.hpp"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+NS_KEPLER_BEGIN
+
+// times passes on the GPU. each scope is bracketed with timestamp queries
+// (unlike GL_TIME_ELAPSED queries, those can nest), and a frame's results are
+// read back at the start of whichever later frame finds them ready, so the
+// profiler never stalls the CPU. frames waiting on their results come from a
+// pool that grows as needed; only past MaxFramesPending of them is the oldest
+// dropped.
+namespace GPUProfiler {
+constexpr std::size_t MaxFramesPending = 16;
+
+// everything between the two is timed as the "frame" pass, and scopes outside
+// of a frame do nothing
+void beginFrame();
+void endFrame();
+
+// times the GPU work issued from its construction to its destruction, as a
+// pass nested inside whichever scope is open
+class Scope {
+   public:
+    explicit Scope(const std::string& name);
+    ~Scope();
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+   private:
+    bool open;
+};
+
+// over the last few hundred frames each pass appeared in (see
+// setHistorySize). times are in milliseconds.
+struct PassStats {
+    // with its parents', e.g. "frame/deferred/stencil"
+    std::string path;
+    std::size_t depth;
+    std::size_t samples;
+    float average;
+    float median;
+    float p95;
+    float p99;
+    float max;
+};
+struct Stats {
+    // each pass comes after its parent
+    std::vector<PassStats> passes;
+    std::size_t framesTimed = 0;
+    std::size_t framesDropped = 0;
+};
+Stats getStats();
+
+// waits for every frame still pending and reads its results back, e.g. at
+// the end of a run
+void flush();
+
+// as a table. throws fs::error_opening_file.
+void writeReport(const fs::AbsolutePath& path);
+
+// how many of the frames each pass appeared in its stats cover. 300 by
+// default.
+void setHistorySize(std::size_t frames);
+
+// forgets everything and deletes the queries. call before the context goes.
+void clear();
+}  // namespace GPUProfiler
+
+NS_KEPLER_END
+
+#endif
@@ -0,0 +1,141 @@
+#include "gl/mesh_arena.hpp"
+#include "gl/gl.hpp"
+#include "gl/shader.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <tuple>
+#include <utility>
+
+NS_KEPLER_BEGIN
+
+namespace {
+constexpr std::size_t initialVertexCapacity = 4096;
+constexpr std::size_t initialIndexCapacity = 3 * initialVertexCapacity;
+
+void copyBuffer(GLuint from,
+                GLuint to,
+                std::size_t fromOffset,
+                std::size_t toOffset,
+                std::size_t size) {
+    if (size == 0) {
+        return;
+    }
+    GL::state::bindBuffer(GL_COPY_READ_BUFFER, from);
+    GL::state::bindBuffer(GL_COPY_WRITE_BUFFER, to);
+    GL_CHECK(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                                 fromOffset, toOffset, size));
+}
+}  // namespace
+
+MeshArena::MeshArena(VertexLayoutDescription in_layout, Shader& in_shader)
+    : layout{in_layout}
+    , shader{in_shader}
+    , vertexCount{0}
+    , indexCount{0}
+    , liveVertexCount{0}
+    , liveIndexCount{0}
+    , vertexCapacity{0} {
+    allocate(initialVertexCapacity, initialIndexCapacity);
+}
+
+auto MeshArena::add(const VertexArrayObject& mesh) -> Range {
+    assert(mesh.getIndexBuffer());
+    assert(mesh.getLayout().attributes == layout.attributes);
+    const auto& meshVertices = mesh.getSharedBuffer();
+    const auto it = entries.find(meshVertices.get());
+    if (it != std::end(entries)) {
+        if (it->second.vertices.lock() == meshVertices) {
+            return it->second.range;
+        }
+        // a new mesh where a dead one used to be
+        liveVertexCount -= it->second.vertexCount;
+        liveIndexCount -= it->second.range.indexCount;
+        entries.erase(it);
+    }
+
+    const auto& meshIndices = mesh.getIndexBuffer();
+    const auto neededVertices = vertexCount + mesh.getVertexCount();
+    const auto neededIndices = indexCount + meshIndices->getElementCount();
+    if (neededVertices > vertexCapacity ||
+        neededIndices > indices->getElementCount()) {
+        grow(std::max(neededVertices, 2 * vertexCapacity),
+             std::max(neededIndices, 2 * indices->getElementCount()));
+    }
+    Entry entry{meshVertices, meshIndices, mesh.getVertexCount(), {}};
+    copyIn(*meshVertices, *meshIndices, entry);
+    return entries.emplace(meshVertices.get(), entry).first->second.range;
+}
+
+void MeshArena::collect() {
+    for (auto it = std::begin(entries); it != std::end(entries);) {
+        if (it->second.vertices.expired() || it->second.indices.expired()) {
+            liveVertexCount -= it->second.vertexCount;
+            liveIndexCount -= it->second.range.indexCount;
+            it = entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    if (liveVertexCount * 2 >= vertexCount &&
+        liveIndexCount * 2 >= indexCount) {
+        return;
+    }
+    // repack what's left from the meshes themselves
+    allocate(vertexCapacity, indices->getElementCount());
+    for (auto& entry : entries) {
+        copyIn(*entry.second.vertices.lock(), *entry.second.indices.lock(),
+               entry.second);
+    }
+}
+
+void MeshArena::allocate(std::size_t newVertexCapacity,
+                         std::size_t newIndexCapacity) {
+    vertices = std::make_shared<VertexAttributeBuffer_base>();
+    GL::state::bindBuffer(GL_COPY_WRITE_BUFFER, vertices->getHandle());
+    GL_CHECK(glBufferData(GL_COPY_WRITE_BUFFER,
+                          newVertexCapacity * layout.stride, nullptr,
+                          GL_STATIC_DRAW));
+    indices = std::make_shared<IndexBuffer>();
+    indices->allocate(newIndexCapacity);
+    vertexCapacity = newVertexCapacity;
+    vertexCount = indexCount = 0;
+    liveVertexCount = liveIndexCount = 0;
+    vao = std::make_unique<VertexArrayObject>(vertices, vertexCapacity, layout,
+                                              indices, shader);
+}
+
+void MeshArena::grow(std::size_t newVertexCapacity,
+                     std::size_t newIndexCapacity) {
+    const auto oldVertices = std::move(vertices);
+    const auto oldIndices = std::move(indices);
+    const auto counts = std::make_tuple(vertexCount, indexCount,
+                                        liveVertexCount, liveIndexCount);
+    allocate(newVertexCapacity, newIndexCapacity);
+    std::tie(vertexCount, indexCount, liveVertexCount, liveIndexCount) =
+          counts;
+    copyBuffer(oldVertices->getHandle(), vertices->getHandle(), 0, 0,
+               vertexCount * layout.stride);
+    copyBuffer(oldIndices->getHandle(), indices->getHandle(), 0, 0,
+               indexCount * sizeof(IndexBuffer::Index));
+}
+
+void MeshArena::copyIn(const VertexAttributeBuffer_base& meshVertices,
+                       const IndexBuffer& meshIndices,
+                       Entry& entry) {
+    const auto meshIndexCount = meshIndices.getElementCount();
+    entry.range = {static_cast<GLuint>(meshIndexCount),
+                   static_cast<GLuint>(indexCount),
+                   static_cast<GLint>(vertexCount)};
+    copyBuffer(meshVertices.getHandle(), vertices->getHandle(), 0,
+               vertexCount * layout.stride, entry.vertexCount * layout.stride);
+    copyBuffer(meshIndices.getHandle(), indices->getHandle(), 0,
+               indexCount * sizeof(IndexBuffer::Index),
+               meshIndexCount * sizeof(IndexBuffer::Index));
+    vertexCount += entry.vertexCount;
+    indexCount += meshIndexCount;
+    liveVertexCount += entry.vertexCount;
+    liveIndexCount += meshIndexCount;
+}
+
+NS_KEPLER_END
@@ -0,0 +1,72 @@
+#ifndef MESH_ARENA_HPP
+#define MESH_ARENA_HPP
+
+#include "common/common.hpp"
+#include "gl/buffer.hpp"
+#include "gl/vertex_array.hpp"
+#include "gl/vertex_layout.hpp"
+
+#include <cstddef>
+#include <map>
+#include <memory>
+
+NS_KEPLER_BEGIN
+
+class Shader;
+
+// copies of indexed meshes that share a vertex layout, packed into a single
+// vertex buffer and a single index buffer, so that one multi-draw can draw
+// any mix of them. meshes are copied in on first use, on the GPU. meshes
+// that nothing else uses anymore are dropped, and once enough of the arena is
+// dead weight it's repacked.
+class MeshArena {
+   public:
+    // as the fields of a DrawElementsIndirectCommand
+    struct Range {
+        GLuint indexCount;
+        GLuint firstIndex;
+        GLint baseVertex;
+    };
+
+    MeshArena(VertexLayoutDescription in_layout, Shader& in_shader);
+
+    // the mesh must be indexed and have this arena's layout
+    Range add(const VertexArrayObject& mesh);
+
+    // set up for the shader the arena was made with. it's replaced whenever
+    // the arena grows, so don't hold on to it.
+    VertexArrayObject& getVertexArray() { return *vao; }
+
+    // drop meshes nothing else holds on to. ranges handed out before this
+    // are no longer valid.
+    void collect();
+
+   private:
+    struct Entry {
+        std::weak_ptr<VertexAttributeBuffer_base> vertices;
+        std::weak_ptr<IndexBuffer> indices;
+        std::size_t vertexCount;
+        Range range;
+    };
+    // fresh, empty buffers
+    void allocate(std::size_t newVertexCapacity, std::size_t newIndexCapacity);
+    void grow(std::size_t newVertexCapacity, std::size_t newIndexCapacity);
+    void copyIn(const VertexAttributeBuffer_base& meshVertices,
+                const IndexBuffer& meshIndices,
+                Entry& entry);
+
+    VertexLayoutDescription layout;
+    std::reference_wrapper<Shader> shader;
+    std::map<const VertexAttributeBuffer_base*, Entry> entries;
+    std::shared_ptr<VertexAttributeBuffer_base> vertices;
+    std::shared_ptr<IndexBuffer> indices;
+    std::unique_ptr<VertexArrayObject> vao;
+    // used, and of that, used by meshes that are still alive
+    std::size_t vertexCount, indexCount;
+    std::size_t liveVertexCount, liveIndexCount;
+    std::size_t vertexCapacity;
+};
+
+NS_KEPLER_END
+
+#endif
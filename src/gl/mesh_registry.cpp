@@ -0,0 +1,157 @@
+#include "gl/mesh_registry.hpp"
+#include "data/mesh_optimizer.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+NS_KEPLER_BEGIN
+
+namespace {
+// FNV-1a
+std::uint64_t hashBytes(const void* data, std::size_t size) {
+    auto bytes = static_cast<const unsigned char*>(data);
+    std::uint64_t hash = 14695981039346656037ull;
+    for (std::size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+struct Entry {
+    std::weak_ptr<VertexAttributeBuffer_base> vertices;
+    // tells vertex types apart
+    const VertexAttribute* layout;
+    std::weak_ptr<IndexBuffer> indices;
+    // of the vertices as they were requested
+    std::size_t count;
+    std::size_t residentBytes;
+    // vertices transformed for the whole mesh, before and after reordering
+    float transformsBefore, transformsAfter;
+    // a copy of the requested vertices, to tell apart meshes whose hashes
+    // collide without reading the buffer back
+    std::vector<Vertex> source;
+};
+std::unordered_multimap<std::uint64_t, Entry> entries;
+std::unordered_multimap<std::uint64_t, Entry> indexedEntries;
+MeshRegistry::Stats stats;
+
+void forgetExpired(std::unordered_multimap<std::uint64_t, Entry>& entries) {
+    for (auto it = std::begin(entries); it != std::end(entries);) {
+        if (it->second.vertices.expired()) {
+            it = entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void shared(std::size_t bytes) {
+    ++stats.sharedRequests;
+    stats.sharedBytes += bytes;
+}
+}  // namespace
+
+namespace MeshRegistry {
+Mesh get(const Vertex* vertices, std::size_t count) {
+    const auto bytes = count * sizeof(Vertex);
+    const auto hash = hashBytes(vertices, bytes);
+    const auto range = entries.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second.count != count) {
+            continue;
+        }
+        auto mesh = std::static_pointer_cast<VertexBuffer>(
+              it->second.vertices.lock());
+        // the hashes match, but only the contents can say for sure
+        if (mesh &&
+            std::memcmp(it->second.source.data(), vertices, bytes) == 0) {
+            shared(bytes);
+            return mesh;
+        }
+    }
+
+    forgetExpired(entries);
+    auto mesh = std::make_shared<VertexBuffer>();
+    mesh->setData(vertices, count);
+    const auto layout = VertexLayout<Vertex>::describe().attributes;
+    entries.emplace(hash, Entry{mesh, layout, {}, count, bytes, 0.f, 0.f,
+                                {vertices, vertices + count}});
+    return mesh;
+}
+
+template <typename V>
+IndexedMesh<V> getIndexed(const Vertex* vertices, std::size_t count) {
+    const auto layout = VertexLayout<V>::describe().attributes;
+    const auto bytes = count * sizeof(Vertex);
+    const auto hash = hashBytes(vertices, bytes);
+    const auto range = indexedEntries.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second.count != count || it->second.layout != layout) {
+            continue;
+        }
+        IndexedMesh<V> mesh{std::static_pointer_cast<VertexAttributeBuffer<V>>(
+                                  it->second.vertices.lock()),
+                            it->second.indices.lock()};
+        // the hashes match, but only the contents can say for sure
+        if (mesh.vertices && mesh.indices &&
+            std::memcmp(it->second.source.data(), vertices, bytes) == 0) {
+            shared(bytes);
+            return mesh;
+        }
+    }
+
+    // only a mesh that isn't resident yet is optimized
+    auto welded = mesh::weld(vertices, count);
+    const auto triangles = welded.indices.size() / 3.f;
+    const auto acmrBefore =
+          mesh::computeACMR(welded.indices, welded.vertices.size());
+    mesh::optimizeVertexCache(welded.indices, welded.vertices.size());
+    mesh::optimizeVertexFetch(welded);
+    const auto acmrAfter =
+          mesh::computeACMR(welded.indices, welded.vertices.size());
+    std::vector<V> converted;
+    converted.reserve(welded.vertices.size());
+    for (const auto& vertex : welded.vertices) {
+        converted.push_back(VertexLayout<V>::fromVertex(vertex));
+    }
+
+    forgetExpired(indexedEntries);
+    IndexedMesh<V> mesh{std::make_shared<VertexAttributeBuffer<V>>(converted),
+                        std::make_shared<IndexBuffer>(welded.indices)};
+    indexedEntries.emplace(
+          hash, Entry{mesh.vertices, layout, mesh.indices, count,
+                      converted.size() * sizeof(V) +
+                            welded.indices.size() * sizeof(IndexBuffer::Index),
+                      acmrBefore * triangles, acmrAfter * triangles,
+                      {vertices, vertices + count}});
+    return mesh;
+}
+template IndexedMesh<Vertex> getIndexed(const Vertex*, std::size_t);
+template IndexedMesh<CompactVertex> getIndexed(const Vertex*, std::size_t);
+
+Stats getStats() {
+    forgetExpired(entries);
+    forgetExpired(indexedEntries);
+    auto current = stats;
+    current.meshes = entries.size() + indexedEntries.size();
+    for (const auto& entry : entries) {
+        current.residentBytes += entry.second.residentBytes;
+    }
+    float transformsBefore = 0.f, transformsAfter = 0.f, triangles = 0.f;
+    for (const auto& entry : indexedEntries) {
+        current.residentBytes += entry.second.residentBytes;
+        transformsBefore += entry.second.transformsBefore;
+        transformsAfter += entry.second.transformsAfter;
+        triangles += entry.second.count / 3.f;
+    }
+    if (triangles > 0.f) {
+        current.acmrBefore = transformsBefore / triangles;
+        current.acmrAfter = transformsAfter / triangles;
+    }
+    return current;
+}
+}  // namespace MeshRegistry
+
+NS_KEPLER_END
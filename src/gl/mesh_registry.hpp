@@ -0,0 +1,59 @@
+#ifndef MESH_REGISTRY_HPP
+#define MESH_REGISTRY_HPP
+
+#include "common/types.hpp"
+#include "gl/buffer.hpp"
+#include "gl/vertex_layout.hpp"
+#include "kepler_config.hpp"
+
+#include <cstddef>
+#include <memory>
+
+NS_KEPLER_BEGIN
+
+// hands out vertex buffers by content, so that any number of requests for the
+// same vertices share a single upload. a mesh stays resident for as long as
+// something holds on to it. meshes are shared, so don't change their data.
+namespace MeshRegistry {
+using Mesh = std::shared_ptr<VertexBuffer>;
+
+Mesh get(const Vertex* vertices, std::size_t count);
+template <typename ContiguousData>
+Mesh get(const ContiguousData& vertices) {
+    return get(vertices.data(), vertices.size());
+}
+
+// the same triangle list, with duplicate vertices welded together and the
+// triangles reordered for the post-transform vertex cache, then converted to
+// the vertex type V (see VertexLayout). Vertex and CompactVertex are
+// available.
+template <typename V>
+struct IndexedMesh {
+    std::shared_ptr<VertexAttributeBuffer<V>> vertices;
+    std::shared_ptr<IndexBuffer> indices;
+};
+template <typename V = Vertex>
+IndexedMesh<V> getIndexed(const Vertex* vertices, std::size_t count);
+template <typename V = Vertex, typename ContiguousData>
+IndexedMesh<V> getIndexed(const ContiguousData& vertices) {
+    return getIndexed<V>(vertices.data(), vertices.size());
+}
+
+struct Stats {
+    std::size_t meshes = 0;
+    // vertices and indices
+    std::size_t residentBytes = 0;
+    // requests that were handed an existing mesh instead of uploading
+    std::size_t sharedRequests = 0;
+    std::size_t sharedBytes = 0;
+    // average cache miss ratio over the resident indexed meshes, before and
+    // after reordering their triangles (see mesh::computeACMR)
+    float acmrBefore = 0.f;
+    float acmrAfter = 0.f;
+};
+Stats getStats();
+}  // namespace MeshRegistry
+
+NS_KEPLER_END
+
+#endif
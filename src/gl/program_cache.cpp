@@ -0,0 +1,234 @@
+#include "gl/program_cache.hpp"
+#include "gl/extensions.hpp"
+#include "util/trace.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+NS_KEPLER_BEGIN
+
+namespace {
+// the file starts with this, then the driver's identity, then the programs
+constexpr char magic[] = {'K', 'P', 'L', 'R', 'P', 'R', 'G', '2'};
+// anything bigger is taken to be a damaged file, not a program
+constexpr std::uint32_t maxBinarySize = 64 << 20;
+
+struct Entry {
+    GLenum format;
+    std::vector<char> binary;
+};
+bool opened = false;
+std::string filePath;
+std::string fileIdentity;
+std::unordered_map<ShaderSources::Digest, Entry, ShaderSources::Digest::Hash>
+      entries;
+// the programs loaded or stored since the file was opened
+std::unordered_set<ShaderSources::Digest, ShaderSources::Digest::Hash> used;
+ProgramCache::Stats stats;
+
+std::string glString(GLenum name) {
+    const auto str = glGetString(name);
+    return str ? reinterpret_cast<const char*>(str) : "";
+}
+
+std::string driverIdentity() {
+    return glString(GL_VENDOR) + '\n' + glString(GL_RENDERER) + '\n' +
+           glString(GL_VERSION);
+}
+
+template <typename T>
+void writeValue(std::ostream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof value);
+}
+template <typename T>
+bool readValue(std::istream& in, T& value) {
+    return static_cast<bool>(
+          in.read(reinterpret_cast<char*>(&value), sizeof value));
+}
+
+void writeHeader(std::ostream& out, const std::string& identity) {
+    out.write(magic, sizeof magic);
+    writeValue(out, static_cast<std::uint32_t>(identity.size()));
+    out.write(identity.data(), identity.size());
+}
+
+void writeEntry(std::ostream& out,
+                const ShaderSources::Digest& key,
+                const Entry& entry) {
+    writeValue(out, key.high);
+    writeValue(out, key.low);
+    writeValue(out, static_cast<std::uint32_t>(entry.format));
+    writeValue(out, static_cast<std::uint32_t>(entry.binary.size()));
+    out.write(entry.binary.data(), entry.binary.size());
+}
+
+// reads the file's programs into entries, and returns whether the whole file
+// was good. a file from another driver has no programs worth reading, and a
+// damaged one keeps those before the damage.
+bool readFile(const std::string& path, const std::string& identity) {
+    std::ifstream in{path, std::ios::binary};
+    char fileMagic[sizeof magic];
+    std::uint32_t identityLength;
+    if (!in.read(fileMagic, sizeof fileMagic) ||
+        !std::equal(std::begin(magic), std::end(magic),
+                    std::begin(fileMagic)) ||
+        !readValue(in, identityLength) || identityLength != identity.size()) {
+        return false;
+    }
+    std::string fileIdentity(identityLength, '\0');
+    if (!in.read(&fileIdentity[0], identityLength) ||
+        fileIdentity != identity) {
+        return false;
+    }
+    for (;;) {
+        ShaderSources::Digest key;
+        if (!readValue(in, key.high)) {
+            return in.eof() && in.gcount() == 0;
+        }
+        std::uint32_t format, size;
+        if (!readValue(in, key.low) || !readValue(in, format) ||
+            !readValue(in, size) || size > maxBinarySize) {
+            return false;
+        }
+        Entry entry{format, std::vector<char>(size)};
+        if (!in.read(entry.binary.data(), size)) {
+            return false;
+        }
+        // a later one replaces one the driver rejected
+        entries[key] = std::move(entry);
+    }
+}
+}  // namespace
+
+namespace ProgramCache {
+void open(const fs::AbsolutePath& path) {
+    close();
+    stats = {};
+    if (!GL::extensions::hasProgramBinary()) {
+        return;
+    }
+    const auto identity = driverIdentity();
+    if (readFile(path.get(), identity)) {
+        if (!std::ofstream{path.get(), std::ios::binary | std::ios::app}) {
+            throw fs::error_opening_file{path.get()};
+        }
+    } else {
+        // start the file over with whatever could be read
+        std::ofstream out{path.get(), std::ios::binary | std::ios::trunc};
+        if (!out) {
+            entries.clear();
+            throw fs::error_opening_file{path.get()};
+        }
+        writeHeader(out, identity);
+        for (const auto& entry : entries) {
+            writeEntry(out, entry.first, entry.second);
+        }
+    }
+    filePath = path.get();
+    fileIdentity = identity;
+    opened = true;
+    stats.programs = entries.size();
+}
+
+void close() {
+    if (opened && !used.empty()) {
+        // programs from sources that have since changed would otherwise pile
+        // up, since nothing ever asks for them again
+        std::ofstream out{filePath, std::ios::binary | std::ios::trunc};
+        if (out) {
+            writeHeader(out, fileIdentity);
+            for (const auto& entry : entries) {
+                if (used.count(entry.first)) {
+                    writeEntry(out, entry.first, entry.second);
+                }
+            }
+        }
+    }
+    opened = false;
+    filePath.clear();
+    fileIdentity.clear();
+    entries.clear();
+    used.clear();
+}
+
+bool isOpen() {
+    return opened;
+}
+
+GLuint load(const ShaderSources::Digest& key) {
+    if (!opened) {
+        return 0;
+    }
+    const auto it = entries.find(key);
+    if (it == std::end(entries)) {
+        ++stats.misses;
+        return 0;
+    }
+    trace::Scope trace{"load program binary"};
+    const auto& entry = it->second;
+    const auto program = glCreateProgram();
+    GL::extensions::programBinary(program, entry.format, entry.binary.data(),
+                                  static_cast<GLsizei>(entry.binary.size()));
+    // a format the driver doesn't know is an error rather than a failed link
+    const auto error = glGetError();
+    GLint success = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (error != GL_NO_ERROR || !success) {
+        glDeleteProgram(program);
+        entries.erase(it);
+        stats.programs = entries.size();
+        ++stats.rejected;
+        return 0;
+    }
+    ++stats.hits;
+    used.insert(key);
+    return program;
+}
+
+void prepare(GLuint program) {
+    if (opened) {
+        GL_CHECK(GL::extensions::programParameteri(
+              program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+    }
+}
+
+void store(const ShaderSources::Digest& key, GLuint program) {
+    if (!opened) {
+        return;
+    }
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return;
+    }
+    Entry entry{0, std::vector<char>(length)};
+    GLsizei written = 0;
+    GL_CHECK(GL::extensions::getProgramBinary(program, length, &written,
+                                              &entry.format,
+                                              entry.binary.data()));
+    if (written <= 0) {
+        return;
+    }
+    entry.binary.resize(written);
+    std::ofstream out{filePath, std::ios::binary | std::ios::app};
+    if (out) {
+        writeEntry(out, key, entry);
+        ++stats.stored;
+    }
+    entries[key] = std::move(entry);
+    used.insert(key);
+    stats.programs = entries.size();
+}
+
+Stats getStats() {
+    return stats;
+}
+}  // namespace ProgramCache
+
+NS_KEPLER_END
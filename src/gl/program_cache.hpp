@@ -0,0 +1,50 @@
+#ifndef PROGRAM_CACHE_HPP
+#define PROGRAM_CACHE_HPP
+
+#include "data/fs.hpp"
+#include "gl/gl.hpp"
+#include "gl/shader.hpp"
+#include "kepler_config.hpp"
+
+#include <cstddef>
+
+NS_KEPLER_BEGIN
+
+// linked programs kept on disk between runs, so a program that was built
+// before is loaded as a binary instead of being compiled and linked again. a
+// binary is only good for the driver that made it, so the file belongs to one
+// driver's vendor, renderer and version strings, and starts over when any of
+// them change. programs are looked up by their sources' digests. without
+// ARB_get_program_binary, or until a file is opened, nothing is cached.
+namespace ProgramCache {
+// reads the file's programs, if it has any, and adds new ones to it as they're
+// linked. the file needn't exist yet. throws fs::error_opening_file if it
+// can't be written.
+void open(const fs::AbsolutePath& path);
+// stops caching. the file stays, written again with only the programs that
+// were loaded or stored since it was opened, unless there weren't any.
+void close();
+bool isOpen();
+
+// a program linked from the cached binary, or 0 if there isn't one or the
+// driver wouldn't take it back
+GLuint load(const ShaderSources::Digest& key);
+// call before linking a program, so that the driver keeps its binary
+void prepare(GLuint program);
+// saves a linked program's binary
+void store(const ShaderSources::Digest& key, GLuint program);
+
+struct Stats {
+    std::size_t programs = 0;
+    std::size_t hits = 0;
+    std::size_t misses = 0;
+    // binaries the driver refused, which are compiled and stored again
+    std::size_t rejected = 0;
+    std::size_t stored = 0;
+};
+Stats getStats();
+}  // namespace ProgramCache
+
+NS_KEPLER_END
+
+#endif
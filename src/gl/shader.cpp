@@ -1,27 +1,28 @@
 #include "gl/shader.hpp"
+#include "data/file_watcher.hpp"
 #include "data/fs.hpp"
+#include "gl/extensions.hpp"
 #include "gl/gl.hpp"
+#include "gl/program_cache.hpp"
 #include "kepler_config.hpp"
 #include "scene/material.hpp"
+#include "util/trace.hpp"
 #include "util/util.hpp"
 
 #include <algorithm>
 #include <cassert>
+#include <iostream>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 NS_KEPLER_BEGIN
 
 using namespace std::string_literals;
 
 namespace {
-struct DeleteShader {
-    void operator()(GLuint shader) const {
-        assert(glIsShader(shader));
-        glDeleteShader(shader);
-    }
-};
-
 GLenum shaderType(const Shader::Type type) {
     switch (type) {
         case Shader::Type::Vertex:
@@ -63,81 +64,663 @@ const char* shaderTypeName(const Shader::Type type) {
 #endif
     }
 }
+
+// which file each source string number in the compiler's errors stands for,
+// past 0, the stage's own sources
+std::string describeIncludes(const std::vector<std::string>& includedFiles) {
+    std::string ret;
+    for (std::size_t i = 0; i < includedFiles.size(); ++i) {
+        ret += (i == 0 ? "(source strings: " : ", ") + std::to_string(i + 1) +
+               " is " + includedFiles[i];
+    }
+    return ret.empty() ? ret : ret + ")\n";
+}
 }  // namespace
 
-std::map<ShaderSources, std::shared_ptr<Shader>> Shader::cache;
+namespace {
+std::unordered_map<ShaderSources::Digest,
+                   std::shared_ptr<Shader>,
+                   ShaderSources::Digest::Hash>
+      cache;
 
-GLuint Shader::create_impl(const ShaderSources& sources) {
-    std::vector<util::RAII<GLuint, DeleteShader, util::Movable>> shaders;
-    shaders.reserve(sources.sources.size());
-    for (auto& sourcePair : sources.sources) {
-        shaders.emplace_back(glCreateShader(shaderType(sourcePair.first)));
-        auto& shader = shaders.back();
+// while watching
+std::unique_ptr<FileWatcher> watcher;
+
+ShaderSources buildSources(const Shader::Builder& build,
+                           std::vector<fs::AbsolutePath>& files) {
+    fs::LoadRecorder recorder;
+    auto sources = build();
+    files = recorder.getPaths();
+    return sources;
+}
+
+bool readsAny(const std::vector<fs::AbsolutePath>& files,
+              const std::vector<fs::AbsolutePath>& changed) {
+    return std::any_of(
+          std::begin(files), std::end(files), [&](const fs::AbsolutePath& f) {
+              return std::any_of(std::begin(changed), std::end(changed),
+                                 [&](const fs::AbsolutePath& c) {
+                                     return c.get() == f.get();
+                                 });
+          });
+}
+
+void bindAttributesAsIn(GLuint program, GLuint previous) {
+    GLint count, maxLength;
+    glGetProgramiv(previous, GL_ACTIVE_ATTRIBUTES, &count);
+    glGetProgramiv(previous, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxLength);
+    std::vector<char> nameBuffer(maxLength);
+    for (GLint i = 0; i < count; ++i) {
+        GLsizei length;
+        GLint size;
+        GLenum type;
+        glGetActiveAttrib(previous, i, maxLength, &length, &size, &type,
+                          nameBuffer.data());
+        const std::string name(nameBuffer.data(), length);
+        // built-ins like gl_VertexID can be listed, but not bound
+        if (name.compare(0, 3, "gl_") == 0) {
+            continue;
+        }
+        const auto location = glGetAttribLocation(previous, name.c_str());
+        if (location != -1) {
+            glBindAttribLocation(program, location, name.c_str());
+        }
+    }
+}
 
+template <typename F>
+void forEachActiveUniform(GLuint program, F f) {
+    GLint count, maxLength;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    std::vector<char> nameBuffer(maxLength);
+    for (GLint i = 0; i < count; ++i) {
+        GLsizei length;
+        GLint size;
+        GLenum type;
+        glGetActiveUniform(program, i, maxLength, &length, &size, &type,
+                           nameBuffer.data());
+        f(std::string(nameBuffer.data(), length), size, type);
+    }
+}
+
+// into the program that's bound
+void copyUniform(GLenum type, GLuint from, GLint fromLocation, GLint location) {
+    GLfloat f[16];
+    GLint i[4];
+    GLuint u[4];
+    switch (type) {
+        case GL_FLOAT:
+            glGetUniformfv(from, fromLocation, f);
+            return glUniform1fv(location, 1, f);
+        case GL_FLOAT_VEC2:
+            glGetUniformfv(from, fromLocation, f);
+            return glUniform2fv(location, 1, f);
+        case GL_FLOAT_VEC3:
+            glGetUniformfv(from, fromLocation, f);
+            return glUniform3fv(location, 1, f);
+        case GL_FLOAT_VEC4:
+            glGetUniformfv(from, fromLocation, f);
+            return glUniform4fv(location, 1, f);
+        case GL_FLOAT_MAT2:
+            glGetUniformfv(from, fromLocation, f);
+            return glUniformMatrix2fv(location, 1, GL_FALSE, f);
+        case GL_FLOAT_MAT3:
+            glGetUniformfv(from, fromLocation, f);
+            return glUniformMatrix3fv(location, 1, GL_FALSE, f);
+        case GL_FLOAT_MAT4:
+            glGetUniformfv(from, fromLocation, f);
+            return glUniformMatrix4fv(location, 1, GL_FALSE, f);
+        case GL_FLOAT_MAT2x3:
+            glGetUniformfv(from, fromLocation, f);
+            return glUniformMatrix2x3fv(location, 1, GL_FALSE, f);
+        case GL_FLOAT_MAT2x4:
+            glGetUniformfv(from, fromLocation, f);
+            return glUniformMatrix2x4fv(location, 1, GL_FALSE, f);
+        case GL_FLOAT_MAT3x2:
+            glGetUniformfv(from, fromLocation, f);
+            return glUniformMatrix3x2fv(location, 1, GL_FALSE, f);
+        case GL_FLOAT_MAT3x4:
+            glGetUniformfv(from, fromLocation, f);
+            return glUniformMatrix3x4fv(location, 1, GL_FALSE, f);
+        case GL_FLOAT_MAT4x2:
+            glGetUniformfv(from, fromLocation, f);
+            return glUniformMatrix4x2fv(location, 1, GL_FALSE, f);
+        case GL_FLOAT_MAT4x3:
+            glGetUniformfv(from, fromLocation, f);
+            return glUniformMatrix4x3fv(location, 1, GL_FALSE, f);
+        case GL_INT_VEC2:
+        case GL_BOOL_VEC2:
+            glGetUniformiv(from, fromLocation, i);
+            return glUniform2iv(location, 1, i);
+        case GL_INT_VEC3:
+        case GL_BOOL_VEC3:
+            glGetUniformiv(from, fromLocation, i);
+            return glUniform3iv(location, 1, i);
+        case GL_INT_VEC4:
+        case GL_BOOL_VEC4:
+            glGetUniformiv(from, fromLocation, i);
+            return glUniform4iv(location, 1, i);
+        case GL_UNSIGNED_INT:
+            glGetUniformuiv(from, fromLocation, u);
+            return glUniform1uiv(location, 1, u);
+        case GL_UNSIGNED_INT_VEC2:
+            glGetUniformuiv(from, fromLocation, u);
+            return glUniform2uiv(location, 1, u);
+        case GL_UNSIGNED_INT_VEC3:
+            glGetUniformuiv(from, fromLocation, u);
+            return glUniform3uiv(location, 1, u);
+        case GL_UNSIGNED_INT_VEC4:
+            glGetUniformuiv(from, fromLocation, u);
+            return glUniform4uiv(location, 1, u);
+        default:
+            // int, bool and the samplers
+            glGetUniformiv(from, fromLocation, i);
+            return glUniform1iv(location, 1, i);
+    }
+}
+
+// those the other program has too, with the same types
+void copyUniformValues(GLuint from, GLuint to) {
+    std::unordered_map<std::string, GLenum> types;
+    forEachActiveUniform(to, [&](std::string name, GLint, GLenum type) {
+        types.emplace(std::move(name), type);
+    });
+    GL::state::useProgram(to);
+    forEachActiveUniform(from, [&](const std::string& name, GLint size,
+                                   GLenum type) {
+        const auto it = types.find(name);
+        if (it == std::end(types) || it->second != type) {
+            return;
+        }
+        // arrays are listed as "name[0]", and copied an element at a time
+        static const std::string arraySuffix = "[0]";
+        const bool isArray =
+              name.size() > arraySuffix.size() &&
+              name.compare(name.size() - arraySuffix.size(),
+                           arraySuffix.size(), arraySuffix) == 0;
+        const auto arrayName =
+              name.substr(0, name.size() - arraySuffix.size());
+        for (GLint element = 0; element < size; ++element) {
+            const auto elementName =
+                  isArray ? arrayName + '[' + std::to_string(element) + ']'
+                          : name;
+            const auto fromLocation =
+                  glGetUniformLocation(from, elementName.c_str());
+            const auto location = glGetUniformLocation(to, elementName.c_str());
+            // members of uniform blocks don't have locations
+            if (fromLocation != -1 && location != -1) {
+                copyUniform(type, from, fromLocation, location);
+            }
+        }
+    });
+}
+
+void copyUniformBlockBindings(GLuint from, GLuint to) {
+    GLint count, maxLength;
+    glGetProgramiv(from, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+    glGetProgramiv(from, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxLength);
+    std::vector<char> nameBuffer(maxLength);
+    for (GLint i = 0; i < count; ++i) {
+        GLsizei length;
+        GLint binding;
+        glGetActiveUniformBlockName(from, i, maxLength, &length,
+                                    nameBuffer.data());
+        glGetActiveUniformBlockiv(from, i, GL_UNIFORM_BLOCK_BINDING, &binding);
+        const std::string name(nameBuffer.data(), length);
+        const auto index = glGetUniformBlockIndex(to, name.c_str());
+        if (index != GL_INVALID_INDEX) {
+            glUniformBlockBinding(to, index, binding);
+        }
+    }
+}
+}  // namespace
+
+struct Shader::Reload {
+    Reload(Builder in_build,
+           std::vector<fs::AbsolutePath> in_files,
+           ShaderSources::Digest in_digest)
+        : build{std::move(in_build)}
+        , files{std::move(in_files)}
+        , digest{in_digest} {
+        getReloads().push_back(this);
+        watch();
+    }
+    ~Reload() {
+        auto& reloads = getReloads();
+        reloads.erase(std::remove(std::begin(reloads), std::end(reloads), this),
+                      std::end(reloads));
+    }
+
+    void watch() const {
+        if (watcher) {
+            for (const auto& file : files) {
+                watcher->add(file);
+            }
+        }
+    }
+
+    // filesChanged when it's because one of its files was written, which
+    // leaves the programs it swapped out before no good
+    void rebuild(bool filesChanged) {
+        trace::Scope trace{"rebuild shader"};
+        std::vector<fs::AbsolutePath> newFiles;
+        try {
+            const auto sources = buildSources(build, newFiles);
+            next = util::nullopt;
+            if (sources.getDigest() == digest) {
+                // written, but no different
+                return;
+            }
+            if (filesChanged) {
+                previous.clear();
+            }
+            const auto it = previous.find(sources.getDigest());
+            if (it != std::end(previous)) {
+                auto program = std::move(it->second);
+                previous.erase(it);
+                swapIn(std::move(program), sources.getDigest());
+            } else {
+                next = compile_impl(sources, shader->getHandle());
+                nextDigest = sources.getDigest();
+            }
+        } catch (const std::exception& e) {
+            // like a file caught halfway through being saved
+            std::cerr << "couldn't rebuild shader: " << e.what() << '\n';
+            return;
+        }
+        files = std::move(newFiles);
+        watch();
+    }
+
+    void finish() {
+        auto pending = std::move(*next);
+        next = util::nullopt;
+        try {
+            swapIn(pending.take(), nextDigest);
+        } catch (const compile_error& e) {
+            std::cerr << "shader reload failed, keeping the old program: "
+                      << e.what() << '\n';
+        }
+    }
+
+    void swapIn(Shader program, ShaderSources::Digest programDigest) {
+        shader->replaceProgram(program);
+        previous.emplace(digest, std::move(program));
+        // create finds it by its new sources now
+        const auto it = cache.find(digest);
+        if (it != std::end(cache) && it->second.get() == shader) {
+            auto cached = std::move(it->second);
+            cache.erase(it);
+            cache.emplace(programDigest, std::move(cached));
+        }
+        digest = programDigest;
+    }
+
+    Builder build;
+    // that build read
+    std::vector<fs::AbsolutePath> files;
+    // of the sources the current program was built from
+    ShaderSources::Digest digest;
+    // null until a Shader takes it
+    Shader* shader = nullptr;
+    // the program being built again, until it's swapped in
+    util::optional<Pending> next;
+    ShaderSources::Digest nextDigest{};
+    // the programs swapped out since the files last changed, by their
+    // sources' digests, for switching back to without compiling
+    std::unordered_map<ShaderSources::Digest,
+                       Shader,
+                       ShaderSources::Digest::Hash>
+          previous;
+};
+
+auto Shader::getReloads() -> std::vector<Reload*>& {
+    static std::vector<Reload*> reloads;
+    return reloads;
+}
+
+Shader::Shader(GLuint program)
+    : GLObject{program}, uniformLocations{getActiveUniformLocations(program)} {}
+
+Shader::Shader(const ShaderSources& sources)
+    : Shader{compileAsync(sources).take()} {}
+
+Shader::Shader(Shader&& other)
+    : GLObject{std::move(other)}
+    , uniformLocations{std::move(other.uniformLocations)}
+    , reload{std::move(other.reload)}
+    , reloadedLocations{std::move(other.reloadedLocations)} {
+    if (reload) {
+        reload->shader = this;
+    }
+}
+
+Shader& Shader::operator=(Shader&& other) {
+    GLObject::operator=(std::move(other));
+    uniformLocations = std::move(other.uniformLocations);
+    reload = std::move(other.reload);
+    reloadedLocations = std::move(other.reloadedLocations);
+    if (reload) {
+        reload->shader = this;
+    }
+    return *this;
+}
+
+Shader::~Shader() = default;
+
+auto Shader::compileAsync(const ShaderSources& sources) -> Pending {
+    if (const auto program = ProgramCache::load(sources.getDigest())) {
+        return Pending{sources.getDigest(), program, {}};
+    }
+    return compile_impl(sources, 0);
+}
+
+auto Shader::compile_impl(const ShaderSources& sources,
+                          GLuint keepAttributesOf) -> Pending {
+    trace::Scope trace{"submit shader"};
+    // nothing is checked here, since asking how a compile went waits for it
+    std::vector<Pending::Stage> stages;
+    stages.reserve(sources.sources.size());
+    auto includedFiles = std::begin(sources.includedFiles);
+    for (auto& sourcePair : sources.sources) {
+        const auto shader = glCreateShader(shaderType(sourcePair.first));
+        stages.push_back({sourcePair.first, shader, *includedFiles++});
         const auto source = ShaderSources::getCompilable(sourcePair.second);
         glShaderSource(shader, source.size(), source.data(), NULL);
         glCompileShader(shader);
-        assert(glIsShader(shader));
+    }
+
+    const auto program = glCreateProgram();
+    ProgramCache::prepare(program);
+    if (keepAttributesOf) {
+        bindAttributesAsIn(program, keepAttributesOf);
+    }
+    for (const auto& stage : stages) {
+        glAttachShader(program, stage.shader);
+    }
+    glLinkProgram(program);
+    GL_CHECK();
+    return Pending{sources.getDigest(), program, std::move(stages)};
+}
+
+auto Shader::compileReloadable(Builder build) -> Pending {
+    std::vector<fs::AbsolutePath> files;
+    const auto sources = buildSources(build, files);
+    auto pending = compileAsync(sources);
+    pending.reload = std::make_unique<Reload>(std::move(build),
+                                              std::move(files),
+                                              sources.getDigest());
+    return pending;
+}
+
+std::shared_ptr<Shader> Shader::createReloadable(Builder build) {
+    std::vector<fs::AbsolutePath> files;
+    const auto sources = buildSources(build, files);
+    auto existing = cache.find(sources.getDigest());
+    if (existing != std::end(cache)) {
+        // possibly made by create, from the same sources
+        auto& shader = *existing->second;
+        if (!shader.reload) {
+            shader.reload = std::make_unique<Reload>(
+                  std::move(build), std::move(files), sources.getDigest());
+            shader.reload->shader = &shader;
+        }
+        return existing->second;
+    }
+    auto pending = compileAsync(sources);
+    pending.reload = std::make_unique<Reload>(std::move(build),
+                                              std::move(files),
+                                              sources.getDigest());
+    return cache
+          .emplace(sources.getDigest(),
+                   std::make_shared<Shader>(pending.take()))
+          .first->second;
+}
+
+void Shader::startWatching() {
+    watcher = std::make_unique<FileWatcher>();
+    for (const auto reload : getReloads()) {
+        reload->watch();
+    }
+}
+
+void Shader::stopWatching() {
+    watcher.reset();
+    for (const auto reload : getReloads()) {
+        reload->next = util::nullopt;
+    }
+}
 
+void Shader::updateReloads() {
+    if (!watcher) {
+        return;
+    }
+    const auto changed = watcher->poll();
+    for (const auto& file : changed) {
+        std::cout << "reloading " << file.get() << '\n';
+    }
+    for (const auto reload : getReloads()) {
+        if (reload->shader && readsAny(reload->files, changed)) {
+            reload->rebuild(true);
+        }
+    }
+    for (const auto reload : getReloads()) {
+        if (reload->next && reload->next->isReady()) {
+            reload->finish();
+        }
+    }
+}
+
+void Shader::rebuildAll() {
+    trace::Scope trace{"rebuild all shaders"};
+    // submitted together, then waited on
+    for (const auto reload : getReloads()) {
+        if (reload->shader) {
+            reload->rebuild(false);
+        }
+    }
+    for (const auto reload : getReloads()) {
+        if (reload->next) {
+            reload->finish();
+        }
+    }
+}
+
+void Shader::replaceProgram(Shader& next) {
+    const auto previous = getHandle();
+    const auto program = next.getHandle();
+    copyUniformValues(previous, program);
+    copyUniformBlockBindings(previous, program);
+
+    // the Uniforms already handed out keep working, through locations
+    std::vector<GLint> locations;
+    for (const auto& uniform : uniformLocations) {
+        const auto id = static_cast<std::size_t>(uniform.second);
+        if (id >= locations.size()) {
+            locations.resize(id + 1, -1);
+        }
+        locations[id] = next.getUniformLocation(uniform.first);
+    }
+    // and uniforms new to the program are given ids past the old ones
+    for (const auto& uniform : next.uniformLocations) {
+        const auto id = static_cast<GLint>(locations.size());
+        if (uniformLocations.emplace(uniform.first, id).second) {
+            locations.push_back(uniform.second);
+        }
+    }
+    reloadedLocations = std::move(locations);
+
+    // and next is left with the old program, as though it had been taken
+    std::swap(handle.get(), next.handle.get());
+    next.uniformLocations = getActiveUniformLocations(next.getHandle());
+    next.reloadedLocations.clear();
+    GL_CHECK();
+}
+
+Shader::Pending::Pending(ShaderSources::Digest in_digest,
+                         GLuint in_program,
+                         std::vector<Stage> in_stages) noexcept
+    : digest{in_digest}, program{in_program}, stages{std::move(in_stages)} {}
+
+Shader::Pending::Pending(Pending&& other) noexcept
+    : digest{other.digest}
+    , program{std::exchange(other.program, 0)}
+    , stages{std::move(other.stages)}
+    , reload{std::move(other.reload)} {
+    other.stages.clear();
+}
+
+auto Shader::Pending::operator=(Pending&& other) noexcept -> Pending& {
+    // other throws away what this had
+    std::swap(digest, other.digest);
+    std::swap(program, other.program);
+    std::swap(stages, other.stages);
+    std::swap(reload, other.reload);
+    return *this;
+}
+
+Shader::Pending::~Pending() {
+    deleteStages();
+    if (program) {
+        detail::DeleteShader{}(program);
+    }
+}
+
+void Shader::Pending::deleteStages() noexcept {
+    for (const auto& stage : stages) {
+        if (program) {
+            glDetachShader(program, stage.shader);
+        }
+        glDeleteShader(stage.shader);
+    }
+    stages.clear();
+}
+
+bool Shader::Pending::isReady() const {
+    if (!program || stages.empty() ||
+        !GL::extensions::hasParallelShaderCompile()) {
+        return true;
+    }
+    GLint complete = GL_FALSE;
+    glGetProgramiv(program, GL_COMPLETION_STATUS_KHR, &complete);
+    return complete == GL_TRUE;
+}
+
+Shader Shader::Pending::take() {
+    assert(program);
+    if (!stages.empty()) {
+        trace::Scope trace{"wait for shader"};
         GLint success;
-        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
         if (!success) {
+            // a stage that didn't compile says more than the link that failed
+            // because of it
+            for (const auto& stage : stages) {
+                glGetShaderiv(stage.shader, GL_COMPILE_STATUS, &success);
+                if (!success) {
+                    char info[512];
+                    GLsizei len;
+                    glGetShaderInfoLog(stage.shader, 512, &len, info);
+                    throw compile_error{
+                          "("s + shaderTypeName(stage.type) + ") " +
+                          std::string(info, len) +
+                          describeIncludes(stage.includedFiles)};
+                }
+            }
             char info[512];
             GLsizei len;
-            glGetShaderInfoLog(shader, 512, &len, info);
-            throw compile_error{"("s + shaderTypeName(sourcePair.first) + ") " +
-                                std::string(info, len)};
+            glGetProgramInfoLog(program, 512, &len, info);
+            throw compile_error{"(program linking) " + std::string(info, len)};
         }
+        deleteStages();
+        ProgramCache::store(digest, program);
+        GL_CHECK();
     }
-
-    const auto program = glCreateProgram();
-    for (auto& shader : shaders) {
-        glAttachShader(program, shader);
+    Shader shader{std::exchange(program, 0)};
+    if (reload) {
+        shader.reload = std::move(reload);
+        shader.reload->shader = &shader;
     }
-    glLinkProgram(program);
+    return shader;
+}
 
-    for (auto& shader : shaders) {
-        glDetachShader(program, shader);
-    }
+auto Shader::getActiveUniformLocations(GLuint program) -> UniformLocations {
+    GLint count, maxLength;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
 
-    GLint success;
-    glGetProgramiv(program, GL_LINK_STATUS, &success);
-    if (!success) {
-        char info[512];
-        GLsizei len;
-        glGetProgramInfoLog(program, 512, &len, info);
-        throw compile_error{"(program linking) " + std::string(info, len)};
-    }
+    UniformLocations locations;
+    std::vector<char> nameBuffer(maxLength);
+    for (GLint i = 0; i < count; ++i) {
+        GLsizei length;
+        GLint size;
+        GLenum type;
+        glGetActiveUniform(program, i, maxLength, &length, &size, &type,
+                           nameBuffer.data());
+        const std::string name(nameBuffer.data(), length);
+        const auto location = glGetUniformLocation(program, name.c_str());
+        if (location == -1) {
+            // members of uniform blocks don't have locations
+            continue;
+        }
+        locations.emplace(name, location);
 
+        // arrays of basic types are reported once, as "name[0]". they can also
+        // be referred to as "name", and each of their elements by index.
+        static const std::string arraySuffix = "[0]";
+        if (name.size() > arraySuffix.size() &&
+            name.compare(name.size() - arraySuffix.size(), arraySuffix.size(),
+                         arraySuffix) == 0) {
+            const auto arrayName =
+                  name.substr(0, name.size() - arraySuffix.size());
+            locations.emplace(arrayName, location);
+            for (GLint element = 1; element < size; ++element) {
+                const auto elementName =
+                      arrayName + '[' + std::to_string(element) + ']';
+                locations.emplace(
+                      elementName,
+                      glGetUniformLocation(program, elementName.c_str()));
+            }
+        }
+    }
     GL_CHECK();
+    return locations;
+}
 
-    return program;
+void Shader::bindUniformBlock(const std::string& name, GLuint bindingPoint) {
+    const auto index = glGetUniformBlockIndex(this->handle, name.c_str());
+    if (index != GL_INVALID_INDEX) {
+        GL_CHECK(glUniformBlockBinding(this->handle, index, bindingPoint));
+    }
 }
 
 void Shader::setUniform(const std::string& name,
                         const Material& material) noexcept {
-    bind();
-    material.diffuse->bind(Material::TextureUnit::Diffuse);
-    setUniform(name + ".diffuse", Material::TextureUnit::Diffuse);
-    material.specular->bind(Material::TextureUnit::Specular);
-    setUniform(name + ".specular", Material::TextureUnit::Specular);
-    setUniform(name + ".shininess", material.shininess);
+    material.applyUniforms(Material::Uniforms{*this, name}, *this);
 }
 
 std::shared_ptr<Shader> Shader::create(const ShaderSources& sources) {
-    auto existing = cache.find(sources);
+    auto existing = cache.find(sources.getDigest());
     if (existing == std::end(cache)) {
-        return cache.emplace(sources, std::make_shared<Shader>(sources))
+        return cache
+              .emplace(sources.getDigest(), std::make_shared<Shader>(sources))
               .first->second;
     }
     return existing->second;
 }
 
+void Shader::clearCache() {
+    cache.clear();
+}
+
 std::shared_ptr<Shader> Shader::create(const fs::AbsolutePath& vertexPath,
                                        const fs::AbsolutePath& fragmentPath) {
-    return create(
-          ShaderSources::withVertAndFrag({fs::loadFileAsString(vertexPath)},
-                                         {fs::loadFileAsString(fragmentPath)}));
+    return createReloadable([vertexPath, fragmentPath] {
+        return ShaderSources::withVertAndFrag(
+              {fs::loadFileAsString(vertexPath)},
+              {fs::loadFileAsString(fragmentPath)});
+    });
 }
 
 ShaderSources ShaderSources::withVertAndFrag(SourceUnit vert, SourceUnit frag) {
@@ -168,6 +751,147 @@ auto ShaderSources::emptyFragmentShader() -> Sources::value_type {
     return {Shader::Type::Fragment, emptyShader()};
 }
 
+namespace {
+// the name in a line like `#include "name"`, or an empty string
+std::string includedName(const std::string& line) {
+    static const char blank[] = " \t";
+    static const std::string directive = "include";
+    auto i = line.find_first_not_of(blank);
+    if (i == std::string::npos || line[i] != '#') {
+        return {};
+    }
+    i = line.find_first_not_of(blank, i + 1);
+    if (i == std::string::npos ||
+        line.compare(i, directive.size(), directive) != 0) {
+        return {};
+    }
+    i = line.find_first_not_of(blank, i + directive.size());
+    if (i == std::string::npos || line[i] != '"') {
+        return {};
+    }
+    const auto end = line.find('"', i + 1);
+    return end == std::string::npos ? std::string{}
+                                     : line.substr(i + 1, end - i - 1);
+}
+
+// #line directives keep the compiler's line numbers those of the files, and
+// give each included file the source string number after its place in
+// included
+void expandIncludes(const std::string& source,
+                    std::size_t stringNumber,
+                    std::vector<std::string>& included,
+                    std::string& out) {
+    std::size_t lineNumber = 1;
+    for (std::size_t begin = 0; begin < source.size(); ++lineNumber) {
+        auto end = source.find('\n', begin);
+        end = end == std::string::npos ? source.size() : end + 1;
+        const auto line = source.substr(begin, end - begin);
+        begin = end;
+        const auto name = includedName(line);
+        if (name.empty()) {
+            out += line;
+            continue;
+        }
+        if (std::find(std::begin(included), std::end(included), name) ==
+            std::end(included)) {
+            included.push_back(name);
+            const auto includedNumber = included.size();
+            out += "#line 1 " + std::to_string(includedNumber) + '\n';
+            expandIncludes(
+                  fs::loadFileAsString(fs::RelativePath{"shaders/" + name}),
+                  includedNumber, included, out);
+            if (out.back() != '\n') {
+                out += '\n';
+            }
+        }
+        out += "#line " + std::to_string(lineNumber + 1) + ' ' +
+               std::to_string(stringNumber) + '\n';
+    }
+}
+}  // namespace
+
+ShaderSources::ShaderSources(Sources in_sources, const Defines& defines)
+    : sources{std::move(in_sources)} {
+    preprocess(defines);
+    digest = computeDigest(sources);
+}
+
+void ShaderSources::preprocess(const Defines& defines) {
+    std::string definitions;
+    for (const auto& define : defines) {
+        definitions += "#define " + define.first + ' ' + define.second + '\n';
+    }
+    includedFiles.reserve(sources.size());
+    for (auto& sourcePair : sources) {
+        auto& units = sourcePair.second;
+        std::vector<std::string> included;
+        for (auto& unit : units) {
+            if (unit.get().find("#include") != std::string::npos) {
+                std::string expanded;
+                expandIncludes(unit.get(), 0, included, expanded);
+                unit = SourceUnit{std::move(expanded)};
+            }
+        }
+        if (!included.empty()) {
+            // string 0 is always the stage's own source. without this, a unit
+            // would start out as whatever string the compiler counts it as,
+            // or where the unit before it left off.
+            for (auto& unit : units) {
+                unit = SourceUnit{"#line 1 0\n" + unit.get()};
+            }
+        }
+        includedFiles.push_back(std::move(included));
+        if (!definitions.empty()) {
+            units.insert(std::begin(units), SourceUnit{definitions});
+        }
+    }
+}
+
+namespace {
+// FNV-1a with the 128-bit prime, 2^88 + 0x13b, worked in two halves
+struct Digester {
+    ShaderSources::Digest digest{0x6c62272e07bb0142ull, 0x62b821756295c58dull};
+
+    void add(const void* data, std::size_t size) {
+        auto bytes = static_cast<const unsigned char*>(data);
+        for (std::size_t i = 0; i < size; ++i) {
+            auto& high = digest.high;
+            auto& low = digest.low;
+            low ^= bytes[i];
+            // the carry out of low * 0x13b, whose halves can't overflow
+            const auto carry =
+                  (((low & 0xffffffffull) * 0x13b >> 32) +
+                   (low >> 32) * 0x13b) >>
+                  32;
+            high = high * 0x13b + carry + (low << 24);
+            low *= 0x13b;
+        }
+    }
+    // its length as well as its text, so that moving text from one unit to
+    // the next changes the digest
+    void add(const ShaderSources::SourceUnit& unit) {
+        const auto size = static_cast<std::uint64_t>(unit.get().size());
+        add(&size, sizeof size);
+        add(unit.get().data(), unit.get().size());
+    }
+};
+}  // namespace
+
+auto ShaderSources::computeDigest(const Sources& sources) noexcept -> Digest {
+    Digester digester;
+    digester.add(versionString());
+    for (const auto& sourcePair : sources) {
+        const auto type = static_cast<std::uint32_t>(sourcePair.first);
+        const auto units = static_cast<std::uint64_t>(sourcePair.second.size());
+        digester.add(&type, sizeof type);
+        digester.add(&units, sizeof units);
+        for (const auto& unit : sourcePair.second) {
+            digester.add(unit);
+        }
+    }
+    return digester.digest;
+}
+
 std::vector<const char*> ShaderSources::getCompilable(
       const Sources::mapped_type& sources) {
     std::vector<const char*> ret;
@@ -11,9 +11,14 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
 #include <exception>
+#include <functional>
 #include <map>
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 NS_KEPLER_BEGIN
@@ -23,23 +28,64 @@ struct Material;
 
 namespace detail {
 struct BindShader {
-    static void bind(GLuint handle) noexcept { GL_CHECK(glUseProgram(handle)); }
+    static void bind(GLuint handle) noexcept { GL::state::useProgram(handle); }
+    static GLuint current() noexcept { return GL::state::getProgram(); }
 };
 struct DeleteShader {
     void operator()(GLuint program) const {
         assert(glIsProgram(program));
         glDeleteProgram(program);
+        GL::state::programDeleted(program);
     }
 };
+
+inline void uploadUniform(GLint location, GLint i) noexcept {
+    glUniform1i(location, i);
+}
+inline void uploadUniform(GLint location, float f) noexcept {
+    glUniform1f(location, f);
+}
+inline void uploadUniform(GLint location, const glm::mat3& m3) noexcept {
+    glUniformMatrix3fv(location, 1, GL_FALSE, glm::value_ptr(m3));
+}
+inline void uploadUniform(GLint location, const glm::mat4& m4) noexcept {
+    glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(m4));
+}
+inline void uploadUniform(GLint location, const glm::vec2& v2) noexcept {
+    glUniform2f(location, v2.x, v2.y);
+}
+inline void uploadUniform(GLint location, const glm::vec3& v3) noexcept {
+    glUniform3f(location, v3.x, v3.y, v3.z);
+}
+inline void uploadUniform(GLint location, const glm::vec4& v4) noexcept {
+    glUniform4f(location, v4.r, v4.g, v4.b, v4.a);
+}
+inline void uploadUniform(GLint location, const glm::ivec3& v3) noexcept {
+    glUniform3i(location, v3.x, v3.y, v3.z);
+}
 }  // namespace detail
 
 struct ShaderSources;
 
 class Shader final : public GLObject<detail::BindShader, detail::DeleteShader> {
    private:
-    static GLuint create_impl(const ShaderSources& sources);
-
-    static std::map<ShaderSources, std::shared_ptr<Shader>> cache;
+    // takes ownership of an already linked program
+    explicit Shader(GLuint program);
+
+    // filled by introspecting the program once it's linked
+    using UniformLocations = std::unordered_map<std::string, GLint>;
+    static UniformLocations getActiveUniformLocations(GLuint program);
+    UniformLocations uniformLocations;
+
+    // what a reloadable program was built from, or null
+    struct Reload;
+    std::unique_ptr<Reload> reload;
+    static std::vector<Reload*>& getReloads();
+    // once reloaded, the locations uniformLocations had in the first program
+    // (which the Uniforms handed out hold on to) index the current program's
+    std::vector<GLint> reloadedLocations;
+    // next is left with the program this had
+    void replaceProgram(Shader& next);
 
    public:
     enum class Type {
@@ -55,9 +101,41 @@ class Shader final : public GLObject<detail::BindShader, detail::DeleteShader> {
 #endif
     };
 
-    Shader(const ShaderSources& sources) : GLObject{create_impl(sources)} {}
-
-    static void clearCache() { cache.clear(); }
+    // compiles and links right away. throws compile_error.
+    Shader(const ShaderSources& sources);
+
+    // a program whose compiling and linking have been handed to the driver,
+    // but not waited on. submitting a batch of them before taking any lets a
+    // driver with KHR_parallel_shader_compile build them all at once; without
+    // it, they're built one after another, as they're taken.
+    class Pending;
+    // from the program cache if it's there, otherwise compiled and linked
+    static Pending compileAsync(const ShaderSources& sources);
+
+    // hot reloading. a reloadable program remembers the function that built
+    // its sources and the files that function read. while watching, writing
+    // to one of those files builds the program again in the background, and
+    // updateReloads swaps it in for the old one in place, leaving the old one
+    // if the new one doesn't compile. uniform locations, uniform values,
+    // uniform block bindings and attribute locations carry over.
+    using Builder = std::function<ShaderSources()>;
+    static Pending compileReloadable(Builder build);
+    static std::shared_ptr<Shader> createReloadable(Builder build);
+
+    static void startWatching();
+    // also drops the rebuilds still in flight
+    static void stopWatching();
+    // call between frames. without KHR_parallel_shader_compile, this waits
+    // for a rebuilt program the frame after its file is written.
+    static void updateReloads();
+    // builds every reloadable program again now, whether or not it's being
+    // watched, for when something its builder reads other than files has
+    // changed. a program already built from the same sources is swapped back
+    // in without compiling.
+    static void rebuildAll();
+
+    // forgets the programs create handed out, by their sources' digests
+    static void clearCache();
 
     struct compile_error : std::runtime_error {
         using runtime_error::runtime_error;
@@ -67,53 +145,56 @@ class Shader final : public GLObject<detail::BindShader, detail::DeleteShader> {
     static std::shared_ptr<Shader> create(const fs::AbsolutePath& vertexPath,
                                           const fs::AbsolutePath& fragmentPath);
 
-    Shader& operator=(Shader&& other) = default;
-    Shader(Shader&& other) = default;
+    Shader& operator=(Shader&& other);
+    Shader(Shader&& other);
+    ~Shader();
 
     GLint getAttributeLocation(const std::string& attrib) const noexcept {
         return glGetAttribLocation(this->handle, attrib.c_str());
     }
     GLint getUniformLocation(const std::string& uniform) const noexcept {
-        return glGetUniformLocation(this->handle, uniform.c_str());
+        return getLocation(getUniform(uniform));
     }
 
-    void setUniform(const std::string& name, GLint i) noexcept {
-        bind();
-        glUniform1i(getUniformLocation(name), i);
+    // a uniform location resolved once up front, so that setting it doesn't
+    // need a string lookup. -1 (i.e. inactive uniforms) is silently ignored by
+    // glUniform*, same as before.
+    struct Uniform : util::wrap<GLint, false> {
+        using wrap::wrap;
+        explicit operator bool() const { return get() != -1; }
+    };
+    Uniform getUniform(const std::string& uniform) const noexcept {
+        const auto it = uniformLocations.find(uniform);
+        return Uniform{it != std::end(uniformLocations) ? it->second : -1};
     }
 
-    void setUniform(const std::string& name, float f) noexcept {
+    template <typename T>
+    void setUniform(Uniform uniform, const T& t) noexcept {
         bind();
-        glUniform1f(getUniformLocation(name), f);
+        detail::uploadUniform(getLocation(uniform), t);
     }
-
-    void setUniform(const std::string& name, const glm::mat3& m3) noexcept {
-        bind();
-        glUniformMatrix3fv(getUniformLocation(name), 1, GL_FALSE,
-                           glm::value_ptr(m3));
-    }
-    void setUniform(const std::string& name, const glm::mat4& m4) noexcept {
-        bind();
-        glUniformMatrix4fv(getUniformLocation(name), 1, GL_FALSE,
-                           glm::value_ptr(m4));
+    template <typename T>
+    void setUniform(const std::string& name, const T& t) noexcept {
+        setUniform(getUniform(name), t);
     }
 
-    void setUniform(const std::string& name, const glm::vec2& v2) noexcept {
-        bind();
-        glUniform2f(getUniformLocation(name), v2.x, v2.y);
-    }
+    void setUniform(const std::string& name, const Material& material) noexcept;
 
-    void setUniform(const std::string& name, const glm::vec3& v3) noexcept {
-        bind();
-        glUniform3f(getUniformLocation(name), v3.x, v3.y, v3.z);
-    }
+    // does nothing if the program has no active block by that name
+    void bindUniformBlock(const std::string& name, GLuint bindingPoint);
 
-    void setUniform(const std::string& name, const glm::vec4& v4) noexcept {
-        bind();
-        glUniform4f(getUniformLocation(name), v4.r, v4.g, v4.b, v4.a);
+   private:
+    // skips the program cache. the attributes of keepAttributesOf, unless
+    // it's 0, are bound to the locations they have there.
+    static Pending compile_impl(const ShaderSources& sources,
+                                GLuint keepAttributesOf);
+
+    GLint getLocation(Uniform uniform) const noexcept {
+        const auto location = uniform.get();
+        return location == -1 || reloadedLocations.empty()
+                     ? location
+                     : reloadedLocations[location];
     }
-
-    void setUniform(const std::string& name, const Material& material) noexcept;
 };
 
 struct ShaderSources {
@@ -126,26 +207,96 @@ struct ShaderSources {
     };
     using Sources = std::multimap<Shader::Type, std::vector<SourceUnit>>;
 
-    ShaderSources(Sources in_sources) noexcept
-        : sources{std::move(in_sources)} {}
+    // 128 bits of FNV-1a over everything that goes into the program, the
+    // version line included. programs are cached by this rather than by their
+    // sources.
+    struct Digest {
+        std::uint64_t high;
+        std::uint64_t low;
+
+        bool operator==(const Digest& other) const {
+            return high == other.high && low == other.low;
+        }
+        bool operator!=(const Digest& other) const { return !(*this == other); }
+
+        struct Hash {
+            std::size_t operator()(const Digest& digest) const noexcept {
+                return static_cast<std::size_t>(digest.low ^
+                                                (digest.high * 31));
+            }
+        };
+    };
+
+    // NAME to value, #defined ahead of every stage. programs built from the
+    // same files with different defines are different programs, cached
+    // separately.
+    using Defines = std::map<std::string, std::string>;
+
+    // a line like
+    //   #include "lighting.glsl"
+    // is replaced with shaders/lighting.glsl. a file goes into a stage once
+    // however often it's included, and an #if around an include doesn't stop
+    // it. the compiler numbers the stage's included files 1 and up in its
+    // errors, and compile_error says which is which. throws
+    // fs::error_opening_file.
+    ShaderSources(Sources in_sources, const Defines& defines = {});
 
     static ShaderSources withVertAndFrag(SourceUnit vert, SourceUnit frag);
 
     static Sources::value_type emptyVertexShader();
     static Sources::value_type emptyFragmentShader();
 
-    bool operator<(const ShaderSources& other) const {
-        return sources < other.sources;
-    }
+    const Digest& getDigest() const { return digest; }
 
    private:
     Sources sources;
+    Digest digest;
+    // per stage, in the same order as sources
+    std::vector<std::vector<std::string>> includedFiles;
+
+    void preprocess(const Defines& defines);
+    static Digest computeDigest(const Sources& sources) noexcept;
 
     static const SourceUnit& versionString();
     friend class Shader;
     static std::vector<const char*> getCompilable(const Sources::mapped_type&);
 };
 
+class Shader::Pending {
+   public:
+    Pending(Pending&& other) noexcept;
+    Pending& operator=(Pending&& other) noexcept;
+    // an untaken program is thrown away
+    ~Pending();
+
+    // whether take would return without waiting
+    bool isReady() const;
+    // waits for the program if need be. throws compile_error. can only be
+    // called once.
+    Shader take();
+
+   private:
+    friend class Shader;
+    struct Stage {
+        Shader::Type type;
+        GLuint shader;
+        // by their source string numbers, less one
+        std::vector<std::string> includedFiles;
+    };
+    Pending(ShaderSources::Digest digest,
+            GLuint program,
+            std::vector<Stage> stages) noexcept;
+    void deleteStages() noexcept;
+
+    ShaderSources::Digest digest;
+    // 0 once taken
+    GLuint program;
+    // empty for a program that was loaded rather than compiled
+    std::vector<Stage> stages;
+    // handed on to the Shader
+    std::unique_ptr<Shader::Reload> reload;
+};
+
 NS_KEPLER_END
 
 #endif
@@ -0,0 +1,339 @@
+#include "gl/state.hpp"
+#include "gl/gl.hpp"
+#include "util/optional.hpp"
+
+#include <array>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+
+NS_KEPLER_BEGIN
+
+namespace {
+template <typename T>
+using Shadowed = util::optional<T>;
+
+using StencilOp = std::array<GLenum, 3>;
+
+// a size of 0 is the whole buffer, as bound by glBindBufferBase
+struct IndexedBinding {
+    GLuint buffer;
+    GLintptr offset;
+    GLsizeiptr size;
+
+    bool operator==(const IndexedBinding& other) const {
+        return buffer == other.buffer && offset == other.offset &&
+               size == other.size;
+    }
+};
+
+struct Shadow {
+    Shadowed<GLuint> program;
+    Shadowed<GLuint> vertexArray;
+    std::unordered_map<GLenum, GLuint> buffers;
+    std::map<std::pair<GLenum, GLuint>, IndexedBinding> indexedBuffers;
+    Shadowed<GLuint> readFramebuffer;
+    Shadowed<GLuint> drawFramebuffer;
+    Shadowed<GLuint> activeTexture;
+    // by unit and target
+    std::map<std::pair<GLuint, GLenum>, GLuint> textures;
+
+    std::unordered_map<GLenum, bool> capabilities;
+    Shadowed<bool> depthMask;
+    Shadowed<GLuint> stencilMask;
+    Shadowed<bool> colorMask;
+    Shadowed<std::pair<GLenum, GLenum>> blendFunc;
+    Shadowed<GLenum> depthFunc;
+    Shadowed<GLenum> cullFace;
+    Shadowed<std::tuple<GLenum, GLint, GLuint>> stencilFunc;
+    Shadowed<StencilOp> stencilOpFront;
+    Shadowed<StencilOp> stencilOpBack;
+};
+
+Shadow shadow;
+GL::state::Stats stats;
+
+bool filtered(bool redundant) {
+    if (redundant) {
+        ++stats.filtered;
+    } else {
+        ++stats.issued;
+    }
+    return redundant;
+}
+
+template <typename T>
+bool filtered(Shadowed<T>& current, const T& value) {
+    if (filtered(current && *current == value)) {
+        return true;
+    }
+    current = value;
+    return false;
+}
+
+template <typename T>
+void forget(Shadowed<T>& current, const T& value) {
+    if (current && *current == value) {
+        current = util::nullopt;
+    }
+}
+
+template <typename T>
+void unbind(Shadowed<T>& current, const T& value) {
+    if (current && *current == value) {
+        current = 0;
+    }
+}
+}  // namespace
+
+namespace GL {
+namespace state {
+Stats getStats() {
+    return stats;
+}
+
+void resetStats() {
+    stats = {};
+}
+
+void invalidate() {
+    shadow = {};
+}
+
+void useProgram(GLuint program) {
+    if (!filtered(shadow.program, program)) {
+        GL_CHECK(glUseProgram(program));
+    }
+}
+
+void bindVertexArray(GLuint vao) {
+    if (!filtered(shadow.vertexArray, vao)) {
+        GL_CHECK(glBindVertexArray(vao));
+        // the element array binding is part of the VAO's state
+        shadow.buffers.erase(GL_ELEMENT_ARRAY_BUFFER);
+    }
+}
+
+void bindBuffer(GLenum target, GLuint buffer) {
+    const auto it = shadow.buffers.find(target);
+    if (!filtered(it != std::end(shadow.buffers) && it->second == buffer)) {
+        GL_CHECK(glBindBuffer(target, buffer));
+        shadow.buffers[target] = buffer;
+    }
+}
+
+void bindBufferBase(GLenum target, GLuint index, GLuint buffer) {
+    const IndexedBinding binding{buffer, 0, 0};
+    const auto it = shadow.indexedBuffers.find({target, index});
+    if (!filtered(it != std::end(shadow.indexedBuffers) &&
+                  it->second == binding)) {
+        GL_CHECK(glBindBufferBase(target, index, buffer));
+        shadow.indexedBuffers[{target, index}] = binding;
+        shadow.buffers[target] = buffer;
+    }
+}
+
+void bindBufferRange(GLenum target,
+                     GLuint index,
+                     GLuint buffer,
+                     GLintptr offset,
+                     GLsizeiptr size) {
+    const IndexedBinding binding{buffer, offset, size};
+    const auto it = shadow.indexedBuffers.find({target, index});
+    if (!filtered(it != std::end(shadow.indexedBuffers) &&
+                  it->second == binding)) {
+        GL_CHECK(glBindBufferRange(target, index, buffer, offset, size));
+        shadow.indexedBuffers[{target, index}] = binding;
+        shadow.buffers[target] = buffer;
+    }
+}
+
+void bindFramebuffer(GLenum target, GLuint fbo) {
+    switch (target) {
+        case GL_FRAMEBUFFER:
+            if (!filtered(shadow.readFramebuffer && shadow.drawFramebuffer &&
+                          *shadow.readFramebuffer == fbo &&
+                          *shadow.drawFramebuffer == fbo)) {
+                GL_CHECK(glBindFramebuffer(target, fbo));
+                shadow.readFramebuffer = shadow.drawFramebuffer = fbo;
+            }
+            break;
+        case GL_READ_FRAMEBUFFER:
+            if (!filtered(shadow.readFramebuffer, fbo)) {
+                GL_CHECK(glBindFramebuffer(target, fbo));
+            }
+            break;
+        case GL_DRAW_FRAMEBUFFER:
+            if (!filtered(shadow.drawFramebuffer, fbo)) {
+                GL_CHECK(glBindFramebuffer(target, fbo));
+            }
+            break;
+    }
+}
+
+void bindTexture(GLuint unit, GLuint texture, GLenum target) {
+    const auto it = shadow.textures.find({unit, target});
+    if (filtered(it != std::end(shadow.textures) && it->second == texture)) {
+        return;
+    }
+    if (!filtered(shadow.activeTexture, unit)) {
+        GL_CHECK(glActiveTexture(GL_TEXTURE0 + unit));
+    }
+    GL_CHECK(glBindTexture(target, texture));
+    shadow.textures[{unit, target}] = texture;
+}
+
+GLuint getProgram() {
+    return shadow.program.value_or(0);
+}
+
+GLuint getVertexArray() {
+    return shadow.vertexArray.value_or(0);
+}
+
+GLuint getBuffer(GLenum target) {
+    const auto it = shadow.buffers.find(target);
+    return it != std::end(shadow.buffers) ? it->second : 0;
+}
+
+GLuint getFramebuffer(GLenum target) {
+    switch (target) {
+        case GL_READ_FRAMEBUFFER:
+            return shadow.readFramebuffer.value_or(0);
+        case GL_FRAMEBUFFER:
+        case GL_DRAW_FRAMEBUFFER:
+            return shadow.drawFramebuffer.value_or(0);
+    }
+    return 0;
+}
+
+void setEnabled(GLenum capability, bool enabled) {
+    const auto it = shadow.capabilities.find(capability);
+    if (filtered(it != std::end(shadow.capabilities) &&
+                 it->second == enabled)) {
+        return;
+    }
+    if (enabled) {
+        GL_CHECK(glEnable(capability));
+    } else {
+        GL_CHECK(glDisable(capability));
+    }
+    shadow.capabilities[capability] = enabled;
+}
+
+void depthMask(bool enabled) {
+    if (!filtered(shadow.depthMask, enabled)) {
+        GL_CHECK(glDepthMask(enabled ? GL_TRUE : GL_FALSE));
+    }
+}
+
+void stencilMask(GLuint mask) {
+    if (!filtered(shadow.stencilMask, mask)) {
+        GL_CHECK(glStencilMask(mask));
+    }
+}
+
+void colorMask(bool enabled) {
+    if (!filtered(shadow.colorMask, enabled)) {
+        const GLboolean mask = enabled ? GL_TRUE : GL_FALSE;
+        GL_CHECK(glColorMask(mask, mask, mask, mask));
+    }
+}
+
+void blendFunc(GLenum source, GLenum destination) {
+    if (!filtered(shadow.blendFunc, std::make_pair(source, destination))) {
+        GL_CHECK(glBlendFunc(source, destination));
+    }
+}
+
+void depthFunc(GLenum func) {
+    if (!filtered(shadow.depthFunc, func)) {
+        GL_CHECK(glDepthFunc(func));
+    }
+}
+
+void cullFace(GLenum face) {
+    if (!filtered(shadow.cullFace, face)) {
+        GL_CHECK(glCullFace(face));
+    }
+}
+
+void stencilFunc(GLenum func, GLint ref, GLuint mask) {
+    if (!filtered(shadow.stencilFunc, std::make_tuple(func, ref, mask))) {
+        GL_CHECK(glStencilFunc(func, ref, mask));
+    }
+}
+
+void stencilOpSeparate(GLenum face,
+                       GLenum stencilFail,
+                       GLenum depthFail,
+                       GLenum depthPass) {
+    const StencilOp op{{stencilFail, depthFail, depthPass}};
+    switch (face) {
+        case GL_FRONT:
+            if (!filtered(shadow.stencilOpFront, op)) {
+                GL_CHECK(glStencilOpSeparate(face, stencilFail, depthFail,
+                                             depthPass));
+            }
+            break;
+        case GL_BACK:
+            if (!filtered(shadow.stencilOpBack, op)) {
+                GL_CHECK(glStencilOpSeparate(face, stencilFail, depthFail,
+                                             depthPass));
+            }
+            break;
+        case GL_FRONT_AND_BACK:
+            if (!filtered(shadow.stencilOpFront && shadow.stencilOpBack &&
+                          *shadow.stencilOpFront == op &&
+                          *shadow.stencilOpBack == op)) {
+                GL_CHECK(glStencilOpSeparate(face, stencilFail, depthFail,
+                                             depthPass));
+                shadow.stencilOpFront = shadow.stencilOpBack = op;
+            }
+            break;
+    }
+}
+
+void programDeleted(GLuint program) {
+    // a program that's in use is only flagged for deletion, so whether it's
+    // still bound is anybody's guess
+    forget(shadow.program, program);
+}
+
+void vertexArrayDeleted(GLuint vao) {
+    if (shadow.vertexArray && *shadow.vertexArray == vao) {
+        shadow.vertexArray = 0u;
+        shadow.buffers.erase(GL_ELEMENT_ARRAY_BUFFER);
+    }
+}
+
+void bufferDeleted(GLuint buffer) {
+    for (auto& binding : shadow.buffers) {
+        if (binding.second == buffer) {
+            binding.second = 0;
+        }
+    }
+    for (auto& binding : shadow.indexedBuffers) {
+        if (binding.second.buffer == buffer) {
+            binding.second = {0, 0, 0};
+        }
+    }
+}
+
+void framebufferDeleted(GLuint fbo) {
+    unbind(shadow.readFramebuffer, fbo);
+    unbind(shadow.drawFramebuffer, fbo);
+}
+
+void textureDeleted(GLuint texture) {
+    for (auto& binding : shadow.textures) {
+        if (binding.second == texture) {
+            binding.second = 0;
+        }
+    }
+}
+}  // namespace state
+}  // namespace GL
+
+NS_KEPLER_END
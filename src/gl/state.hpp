@@ -0,0 +1,74 @@
+#ifndef STATE_HPP
+#define STATE_HPP
+
+#include "kepler_config.hpp"
+
+#include <glad/glad.h>
+
+#include <cstddef>
+
+NS_KEPLER_BEGIN
+
+namespace GL {
+// a shadow copy of the bits of GL state the renderer touches, so that
+// redundant binds and toggles never reach the driver. everything starts out
+// unknown, meaning the first call for any given piece of state always goes
+// through. anything that changes this state must go through here, otherwise
+// the shadow goes stale.
+namespace state {
+struct Stats {
+    std::size_t issued = 0;
+    std::size_t filtered = 0;
+};
+Stats getStats();
+void resetStats();
+
+// forget everything, e.g. after something outside of kepler has touched the
+// context
+void invalidate();
+
+void useProgram(GLuint program);
+void bindVertexArray(GLuint vao);
+void bindBuffer(GLenum target, GLuint buffer);
+// also binds the buffer to the target's generic binding point, like GL does
+void bindBufferBase(GLenum target, GLuint index, GLuint buffer);
+void bindBufferRange(GLenum target,
+                     GLuint index,
+                     GLuint buffer,
+                     GLintptr offset,
+                     GLsizeiptr size);
+// GL_FRAMEBUFFER binds both the read and draw framebuffers
+void bindFramebuffer(GLenum target, GLuint fbo);
+void bindTexture(GLuint unit, GLuint texture, GLenum target = GL_TEXTURE_2D);
+
+// 0 if nothing (or something unknown) is bound
+GLuint getProgram();
+GLuint getVertexArray();
+GLuint getBuffer(GLenum target);
+GLuint getFramebuffer(GLenum target);
+
+void setEnabled(GLenum capability, bool enabled);
+void depthMask(bool enabled);
+void stencilMask(GLuint mask);
+void colorMask(bool enabled);
+void blendFunc(GLenum source, GLenum destination);
+void depthFunc(GLenum func);
+void cullFace(GLenum face);
+void stencilFunc(GLenum func, GLint ref, GLuint mask);
+void stencilOpSeparate(GLenum face,
+                       GLenum stencilFail,
+                       GLenum depthFail,
+                       GLenum depthPass);
+
+// deleting a bound object implicitly unbinds it
+void programDeleted(GLuint program);
+void vertexArrayDeleted(GLuint vao);
+void bufferDeleted(GLuint buffer);
+void framebufferDeleted(GLuint fbo);
+void textureDeleted(GLuint texture);
+}  // namespace state
+}  // namespace GL
+
+NS_KEPLER_END
+
+#endif
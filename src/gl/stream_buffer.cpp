@@ -0,0 +1,145 @@
+#include "gl/stream_buffer.hpp"
+#include "gl/binding.hpp"
+#include "gl/extensions.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+
+NS_KEPLER_BEGIN
+
+namespace {
+constexpr GLbitfield persistentFlags =
+      GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+// nothing written to the buffer is read back, and the fences make sure that
+// nothing the GPU might still read is overwritten
+constexpr GLbitfield unsynchronizedFlags = GL_MAP_WRITE_BIT |
+                                           GL_MAP_INVALIDATE_RANGE_BIT |
+                                           GL_MAP_UNSYNCHRONIZED_BIT;
+constexpr GLuint64 waitTimeout = 1000000000;  // 1s, in ns
+
+std::uint64_t alignUp(std::uint64_t offset, std::size_t alignment) {
+    return (offset + alignment - 1) / alignment * alignment;
+}
+}  // namespace
+
+StreamBuffer::StreamBuffer(std::size_t in_capacity)
+    : capacity{in_capacity}
+    , mapping{nullptr}
+    , head{0}
+    , retired{0}
+    , frameStart{0} {
+    RAIIBinding<VertexAttributeBuffer_base> binding{*this};
+    if (GL::extensions::hasBufferStorage()) {
+        GL_CHECK(GL::extensions::bufferStorage(target, capacity, nullptr,
+                                               persistentFlags));
+        mapping = static_cast<unsigned char*>(
+              glMapBufferRange(target, 0, capacity, persistentFlags));
+        GL_CHECK();
+    } else {
+        GL_CHECK(glBufferData(target, capacity, nullptr, GL_STREAM_DRAW));
+    }
+}
+
+StreamBuffer::~StreamBuffer() {
+    for (const auto& fence : fences) {
+        glDeleteSync(fence.sync);
+    }
+    if (mapping) {
+        RAIIBinding<VertexAttributeBuffer_base> binding{*this};
+        glUnmapBuffer(target);
+    }
+}
+
+std::size_t StreamBuffer::write(const void* data,
+                                std::size_t size,
+                                std::size_t alignment) {
+    assert(alignment > 0 && capacity % alignment == 0);
+    if (size > capacity) {
+        throw std::length_error{"too much data for the stream buffer"};
+    }
+    auto begin = alignUp(head, alignment);
+    if (begin % capacity + size > capacity) {
+        // doesn't fit before the end, so start over at the beginning
+        begin = alignUp(begin, capacity);
+    }
+    if (begin + size > capacity) {
+        // the bytes in the way are whatever was written one lap ago. the
+        // skipped ones were never written at all.
+        waitUntilRetired(std::min(begin + size - capacity, head));
+    }
+    const auto offset = static_cast<std::size_t>(begin % capacity);
+
+    if (mapping) {
+        std::memcpy(mapping + offset, data, size);
+    } else {
+        RAIIBinding<VertexAttributeBuffer_base> binding{*this};
+        const auto destination =
+              glMapBufferRange(target, offset, size, unsynchronizedFlags);
+        GL_CHECK();
+        std::memcpy(destination, data, size);
+        GL_CHECK(glUnmapBuffer(target));
+    }
+    head = begin + size;
+    stats.bytesWritten += size;
+    return offset;
+}
+
+void StreamBuffer::endFrame() {
+    fence();
+    // orphaning hands the old storage over to whatever's still reading it, so
+    // there's nothing to wait for. it's only safe between frames, though,
+    // since anything written this frame but not yet drawn would be lost.
+    const auto frameSize = head - frameStart;
+    if (!mapping && head % capacity + frameSize > capacity) {
+        orphan();
+    }
+    frameStart = head;
+    lastFrameStats = stats;
+    stats = {};
+}
+
+void StreamBuffer::fence() {
+    const auto fenced = fences.empty() ? retired : fences.back().end;
+    if (head > fenced) {
+        fences.push_back(
+              {glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), head});
+        GL_CHECK();
+    }
+}
+
+void StreamBuffer::waitUntilRetired(std::uint64_t end) {
+    while (retired < end) {
+        if (fences.empty()) {
+            // this frame alone has lapped the buffer
+            fence();
+        }
+        const auto oldest = fences.front();
+        GLenum result;
+        do {
+            result = glClientWaitSync(oldest.sync, GL_SYNC_FLUSH_COMMANDS_BIT,
+                                      waitTimeout);
+        } while (result == GL_TIMEOUT_EXPIRED);
+        GL_CHECK();
+        if (result == GL_CONDITION_SATISFIED) {
+            ++stats.waits;
+        }
+        glDeleteSync(oldest.sync);
+        fences.pop_front();
+        retired = oldest.end;
+    }
+}
+
+void StreamBuffer::orphan() {
+    for (const auto& fence : fences) {
+        glDeleteSync(fence.sync);
+    }
+    fences.clear();
+    RAIIBinding<VertexAttributeBuffer_base> binding{*this};
+    GL_CHECK(glBufferData(target, capacity, nullptr, GL_STREAM_DRAW));
+    retired = head = alignUp(head, capacity);
+    ++stats.orphans;
+}
+
+NS_KEPLER_END
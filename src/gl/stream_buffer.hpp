@@ -0,0 +1,75 @@
+#ifndef STREAM_BUFFER_HPP
+#define STREAM_BUFFER_HPP
+
+#include "common/common.hpp"
+#include "gl/buffer.hpp"
+#include "gl/gl.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+NS_KEPLER_BEGIN
+
+// one large buffer that data only needed for the current frame (instance
+// attributes, uniform blocks) is written into back to back, wrapping around
+// when it reaches the end. everything written in a frame is fenced, so the CPU
+// only ever waits for the GPU if it laps it.
+//
+// with ARB_buffer_storage the buffer is mapped persistently and a write is just
+// a memcpy. under plain 3.3 each write maps its own range unsynchronized, and
+// at the end of a frame the buffer is orphaned instead of wrapped if another
+// frame like it wouldn't fit.
+class StreamBuffer final : public VertexAttributeBuffer_base {
+   public:
+    struct Stats {
+        std::size_t bytesWritten = 0;
+        // times the CPU had to wait for the GPU to finish with some space
+        std::size_t waits = 0;
+        std::size_t orphans = 0;
+    };
+
+    explicit StreamBuffer(std::size_t in_capacity);
+    ~StreamBuffer();
+
+    // copies the data in and returns the offset it went to, a multiple of the
+    // alignment (which must divide the capacity). the data stays put until the
+    // GPU is done with everything issued before the next endFrame.
+    std::size_t write(const void* data,
+                      std::size_t size,
+                      std::size_t alignment = 16);
+    template <typename ContiguousData>
+    std::size_t write(const ContiguousData& data, std::size_t alignment = 16) {
+        return write(data.data(), data.size() * sizeof(*data.data()),
+                     alignment);
+    }
+
+    // call once everything that reads this frame's data has been issued
+    void endFrame();
+
+    bool isPersistentlyMapped() const noexcept { return mapping != nullptr; }
+    std::size_t getCapacity() const noexcept { return capacity; }
+    // for the frame that ended at the last endFrame
+    Stats getLastFrameStats() const noexcept { return lastFrameStats; }
+
+   private:
+    // data written so far is [retired, head) in a stream of bytes that never
+    // wraps. byte i of it lives at i % capacity.
+    struct Fence {
+        GLsync sync;
+        std::uint64_t end;
+    };
+    void fence();
+    void waitUntilRetired(std::uint64_t end);
+    void orphan();
+
+    std::size_t capacity;
+    unsigned char* mapping;
+    std::uint64_t head, retired, frameStart;
+    std::deque<Fence> fences;
+    Stats stats, lastFrameStats;
+};
+
+NS_KEPLER_END
+
+#endif
@@ -34,7 +34,7 @@ GLenum convertFormatSRGB(const GLenum format) {
 }
 
 void setTexParams(GLuint texID, const Texture::Params& params) {
-    glBindTexture(GL_TEXTURE_2D, texID);
+    GL::state::bindTexture(0, texID);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,
                     convertWrap(params.wrapS));
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T,
@@ -53,7 +53,7 @@ GLuint createTexture(Resolution resolution,
     GL_CHECK();
     GLuint texID;
     glGenTextures(1, &texID);
-    glBindTexture(GL_TEXTURE_2D, texID);
+    GL::state::bindTexture(0, texID);
     GL_CHECK(glTexImage2D(GL_TEXTURE_2D, 0,
                           format.internalFormat.value_or(format.format),
                           resolution.width(), resolution.height(), 0,
@@ -61,15 +61,88 @@ GLuint createTexture(Resolution resolution,
     setTexParams(texID, params);
     return texID;
 }
+
+Texture::Format imageFormat(const Image& img, bool srgb) {
+    return {img.getFormat(), GL_UNSIGNED_BYTE,
+            srgb ? util::make_optional(convertFormatSRGB(img.getFormat()))
+                 : util::nullopt};
+}
 }  // namespace
 
+const char* Texture::getName(ColorFormat format) {
+    switch (format) {
+        case ColorFormat::RGBA16F:
+            return "RGBA16F";
+        case ColorFormat::RG16F:
+            return "RG16F";
+        case ColorFormat::R11G11B10F:
+            return "R11G11B10F";
+        case ColorFormat::RGB10A2:
+            return "RGB10A2";
+        case ColorFormat::RGBA8:
+            return "RGBA8";
+    }
+    return "?";
+}
+
+auto Texture::Format::of(ColorFormat format) -> Format {
+    switch (format) {
+        case ColorFormat::RGBA16F:
+            return {GL_RGBA, GL_FLOAT, GL_RGBA16F};
+        case ColorFormat::RG16F:
+            return {GL_RG, GL_FLOAT, GL_RG16F};
+        case ColorFormat::R11G11B10F:
+            return {GL_RGB, GL_FLOAT, GL_R11F_G11F_B10F};
+        case ColorFormat::RGB10A2:
+            return {GL_RGBA, GL_UNSIGNED_INT_2_10_10_10_REV, GL_RGB10_A2};
+        case ColorFormat::RGBA8:
+            return {GL_RGBA, GL_UNSIGNED_BYTE, GL_RGBA8};
+    }
+    assert(false && "unknown color format");
+    return {GL_RGBA, GL_UNSIGNED_BYTE, GL_RGBA8};
+}
+
+std::size_t Texture::Format::getBytesPerPixel() const {
+    if (internalFormat) {
+        switch (*internalFormat) {
+            case GL_RGBA16F:
+                return 8;
+            case GL_RG16F:
+            case GL_R11F_G11F_B10F:
+            case GL_RGB10_A2:
+            case GL_RGBA8:
+            case GL_SRGB8_ALPHA8:
+            case GL_SRGB_ALPHA:
+                return 4;
+            case GL_RGB8:
+            case GL_SRGB8:
+            case GL_SRGB:
+                return 3;
+        }
+        assert(false && "unknown internal format");
+    }
+    std::size_t components = 0;
+    switch (format) {
+        case GL_RED:
+        case GL_DEPTH_COMPONENT:
+            components = 1;
+            break;
+        case GL_RG:
+            components = 2;
+            break;
+        case GL_RGB:
+            components = 3;
+            break;
+        case GL_RGBA:
+            components = 4;
+            break;
+    }
+    return components * (type == GL_FLOAT ? 4 : 1);
+}
+
 GLuint Texture::create(const Image& img, bool srgb, const Params& params) {
-    return createTexture(
-          img.getResolution(),
-          {img.getFormat(), GL_UNSIGNED_BYTE,
-           srgb ? util::make_optional(convertFormatSRGB(img.getFormat()))
-                : util::nullopt},
-          img.data(), params);
+    return createTexture(img.getResolution(), imageFormat(img, srgb),
+                         img.data(), params);
 }
 
 GLuint Texture::create(Resolution resolution,
@@ -79,9 +152,13 @@ GLuint Texture::create(Resolution resolution,
 }
 
 Texture::Texture(const Image& img, bool srgb, const Params& params)
-    : GLObject{create(img, srgb, params)}, resolution{img.getResolution()} {}
+    : GLObject{create(img, srgb, params)}
+    , resolution{img.getResolution()}
+    , format{imageFormat(img, srgb)} {}
 
-Texture::Texture(const Resolution& res, Format format, const Params& params)
-    : GLObject{create(res, format, params)}, resolution{res} {}
+Texture::Texture(const Resolution& res, Format in_format, const Params& params)
+    : GLObject{create(res, in_format, params)}
+    , resolution{res}
+    , format{in_format} {}
 
 NS_KEPLER_END
@@ -8,6 +8,7 @@
 #include "util/util.hpp"
 
 #include <cassert>
+#include <cstddef>
 
 NS_KEPLER_BEGIN
 
@@ -18,6 +19,7 @@ struct DeleteTexture {
     void operator()(GLuint texID) const {
         assert(glIsTexture(texID));
         glDeleteTextures(1, &texID);
+        GL::state::textureDeleted(texID);
     }
 };
 }  // namespace detail
@@ -40,10 +42,35 @@ class Texture : public GLObject<void, detail::DeleteTexture> {
         Filter filterMag = Filter::Linear;
     };
 
+    // the sized color formats render targets can choose between, trading
+    // precision for bandwidth. RG16F has two channels; R11G11B10F has no
+    // alpha and no sign.
+    enum class ColorFormat {
+        RGBA16F,
+        RG16F,
+        R11G11B10F,
+        RGB10A2,
+        RGBA8,
+    };
+    static const char* getName(ColorFormat format);
+
     struct Format {
         GLenum format;
         GLenum type;
         util::optional<GLenum> internalFormat = util::nullopt;
+
+        static Format of(ColorFormat format);
+        // as stored. without an internal format, the driver picks one and
+        // this is a guess.
+        std::size_t getBytesPerPixel() const;
+
+        bool operator==(const Format& other) const {
+            return format == other.format && type == other.type &&
+                   internalFormat == other.internalFormat;
+        }
+        bool operator!=(const Format& other) const {
+            return !(*this == other);
+        }
     };
 
    private:
@@ -64,14 +91,15 @@ class Texture : public GLObject<void, detail::DeleteTexture> {
 
     void bind(GLenum unit) noexcept {
         assert((unit + 1) <= maxBoundTextures());
-        glActiveTexture(GL_TEXTURE0 + unit);
-        glBindTexture(GL_TEXTURE_2D, this->handle);
+        GL::state::bindTexture(unit, this->handle);
     }
 
     Resolution getResolution() const noexcept { return resolution; }
+    const Format& getFormat() const noexcept { return format; }
 
    private:
     Resolution resolution;
+    Format format;
 };
 
 NS_KEPLER_END
@@ -0,0 +1,42 @@
+#include "gl/texture_buffer.hpp"
+#include "gl/binding.hpp"
+#include "gl/gl.hpp"
+
+#include <algorithm>
+
+NS_KEPLER_BEGIN
+
+namespace {
+// never allocate an empty buffer, which some drivers refuse to attach
+constexpr std::size_t minimumCapacity = 256;
+}  // namespace
+
+TextureBuffer::TextureBuffer(GLenum internalFormat)
+    : GLObject{[] {
+        GLuint texID;
+        glGenTextures(1, &texID);
+        return texID;
+    }()}
+    , capacity{minimumCapacity} {
+    {
+        RAIIBinding<Buffer_base<GL_TEXTURE_BUFFER>> binding{buffer};
+        GL_CHECK(glBufferData(GL_TEXTURE_BUFFER, capacity, nullptr,
+                              GL_STREAM_DRAW));
+    }
+    GL::state::bindTexture(0, this->handle, GL_TEXTURE_BUFFER);
+    GL_CHECK(glTexBuffer(GL_TEXTURE_BUFFER, internalFormat,
+                         buffer.getHandle()));
+}
+
+void TextureBuffer::_setData(const void* data, std::size_t size) {
+    RAIIBinding<Buffer_base<GL_TEXTURE_BUFFER>> binding{buffer};
+    if (size > capacity) {
+        capacity = std::max(size, 2 * capacity);
+    }
+    // orphan the old storage rather than waiting for the GPU to finish with it
+    GL_CHECK(glBufferData(GL_TEXTURE_BUFFER, capacity, nullptr,
+                          GL_STREAM_DRAW));
+    GL_CHECK(glBufferSubData(GL_TEXTURE_BUFFER, 0, size, data));
+}
+
+NS_KEPLER_END
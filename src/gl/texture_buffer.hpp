@@ -0,0 +1,39 @@
+#ifndef TEXTURE_BUFFER_HPP
+#define TEXTURE_BUFFER_HPP
+
+#include "common/common.hpp"
+#include "gl/buffer.hpp"
+#include "gl/gl_object.hpp"
+#include "gl/texture.hpp"
+
+#include <cstddef>
+
+NS_KEPLER_BEGIN
+
+// a buffer object that shaders read through a samplerBuffer, for when there's
+// more data than fits in uniforms. the contents are replaced wholesale, e.g.
+// once per frame.
+class TextureBuffer : public GLObject<void, detail::DeleteTexture> {
+   public:
+    // one of the sized formats glTexBuffer accepts, e.g. GL_RGBA32F
+    explicit TextureBuffer(GLenum internalFormat);
+
+    template <typename ContiguousData>
+    void setData(const ContiguousData& data) {
+        _setData(data.data(), data.size() * sizeof(*data.data()));
+    }
+
+    void bind(GLuint unit) noexcept {
+        GL::state::bindTexture(unit, this->handle, GL_TEXTURE_BUFFER);
+    }
+
+   private:
+    void _setData(const void* data, std::size_t size);
+
+    Buffer_base<GL_TEXTURE_BUFFER> buffer;
+    std::size_t capacity;
+};
+
+NS_KEPLER_END
+
+#endif
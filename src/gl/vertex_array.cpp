@@ -5,14 +5,13 @@
 #include "util/util.hpp"
 
 #include <cassert>
+#include <cstring>
 #include <memory>
+#include <utility>
 
 NS_KEPLER_BEGIN
 
 namespace {
-constexpr const auto positionAttributeName = "position";
-constexpr const auto normalAttributeName = "normal";
-constexpr const auto texCoordAttributeName = "texCoord";
 constexpr const auto colorAttributeName = "color";
 
 struct AttributeLocation : util::wrap<GLint, false> {
@@ -22,16 +21,54 @@ struct AttributeLocation : util::wrap<GLint, false> {
 };
 }  // namespace
 
-VertexArrayObject::VertexArrayObject(std::shared_ptr<VertexBuffer> in_vbo,
-                                     Shader& shader)
+VertexArrayObject::VertexArrayObject(
+      std::shared_ptr<VertexAttributeBuffer_base> in_vbo,
+      std::size_t in_vertexCount,
+      VertexLayoutDescription in_layout,
+      std::shared_ptr<IndexBuffer> in_ibo,
+      Shader& shader)
     : GLObject{[] {
         GLuint vao;
         GL_CHECK(glGenVertexArrays(1, &vao));
         return vao;
     }()}
-    , vbo{std::move(in_vbo)} {
+    , vbo{std::move(in_vbo)}
+    , vertexCount{in_vertexCount}
+    , layout{in_layout}
+    , ibo{std::move(in_ibo)} {
     assert(vbo);
     configureVertexAttributes(shader);
+    if (ibo) {
+        // becomes part of the VAO's state, so nothing needs to bind it again
+        GL::state::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo->getHandle());
+        GL_CHECK();
+    }
+}
+
+VertexArrayObject::VertexArrayObject(const VertexArrayObject& source,
+                                     Shader& shader)
+    : VertexArrayObject{source.vbo, source.vertexCount, source.layout,
+                        source.ibo, shader} {}
+
+void VertexArrayObject::draw(GLenum mode) {
+    this->bind();
+    if (ibo) {
+        GL_CHECK(glDrawElements(mode, ibo->getElementCount(),
+                                ibo->getIndexType(), nullptr));
+    } else {
+        GL_CHECK(glDrawArrays(mode, 0, vertexCount));
+    }
+}
+
+void VertexArrayObject::drawInstanced(GLsizei instanceCount, GLenum mode) {
+    this->bind();
+    if (ibo) {
+        GL_CHECK(glDrawElementsInstanced(mode, ibo->getElementCount(),
+                                         ibo->getIndexType(), nullptr,
+                                         instanceCount));
+    } else {
+        GL_CHECK(glDrawArraysInstanced(mode, 0, vertexCount, instanceCount));
+    }
 }
 
 void VertexArrayObject::addInstancedBuffer(
@@ -40,36 +77,73 @@ void VertexArrayObject::addInstancedBuffer(
       std::shared_ptr<VertexAttributeBuffer_base> theBuffer,
       const GLsizei size,
       const GLsizei stride,
+      const std::size_t offset,
+      const GLuint divisor) {
+    const auto location = getAttributeLocation(attribute, shader);
+    if (isBufferAlreadySet(location, theBuffer, offset)) {
+        return;
+    }
+    setAttributePointer(location, std::move(theBuffer), size, stride, offset,
+                        divisor);
+}
+
+void VertexArrayObject::addInstancedMatrix(
+      const std::string& attribute,
+      Shader& shader,
+      std::shared_ptr<VertexAttributeBuffer_base> theBuffer,
+      const GLsizei columns,
+      const GLsizei rows,
+      const GLsizei stride,
+      const std::size_t offset,
       const GLuint divisor) {
+    const auto location = getAttributeLocation(attribute, shader);
+    if (isBufferAlreadySet(location, theBuffer, offset)) {
+        return;
+    }
+    for (GLsizei column = 0; column < columns; ++column) {
+        setAttributePointer(location + column, theBuffer, rows, stride,
+                            offset + column * rows * sizeof(float), divisor);
+    }
+}
+
+GLuint VertexArrayObject::getAttributeLocation(const std::string& attribute,
+                                               Shader& shader) const {
     GL_CHECK();
     shader.bind();
     if (const AttributeLocation location =
               shader.getAttributeLocation(attribute)) {
-        if (isBufferAlreadySet(location, theBuffer)) {
-            return;
-        }
-        RAIIBinding<VertexArrayObject> bindSelf{*this};
-        RAIIBinding<VertexAttributeBuffer_base> bindTheBuffer{*theBuffer};
-        GL_CHECK(glVertexAttribPointer(location, size, GL_FLOAT, GL_FALSE,
-                                       stride, (GLvoid*)0));
-        GL_CHECK(glEnableVertexAttribArray(location));
-        GL_CHECK();
-        additionalBuffers[location] = std::move(theBuffer);
-        if (divisor != 0) {
-            glVertexAttribDivisor(location, divisor);
-        }
-        GL_CHECK();
-    } else {
-        throw nonexistent_attribute_location{attribute};
+        return location;
+    }
+    throw nonexistent_attribute_location{attribute};
+}
+
+void VertexArrayObject::setAttributePointer(
+      const GLuint location,
+      std::shared_ptr<VertexAttributeBuffer_base> theBuffer,
+      const GLsizei size,
+      const GLsizei stride,
+      const std::size_t offset,
+      const GLuint divisor) {
+    RAIIBinding<VertexArrayObject> bindSelf{*this};
+    RAIIBinding<VertexAttributeBuffer_base> bindTheBuffer{*theBuffer};
+    GL_CHECK(glVertexAttribPointer(location, size, GL_FLOAT, GL_FALSE, stride,
+                                   (GLvoid*)offset));
+    GL_CHECK(glEnableVertexAttribArray(location));
+    GL_CHECK();
+    additionalBuffers[location] = {std::move(theBuffer), offset};
+    if (divisor != 0) {
+        glVertexAttribDivisor(location, divisor);
     }
+    GL_CHECK();
 }
 
 bool VertexArrayObject::isBufferAlreadySet(
       GLuint location,
-      const std::shared_ptr<VertexAttributeBuffer_base>& theBuffer) const {
+      const std::shared_ptr<VertexAttributeBuffer_base>& theBuffer,
+      std::size_t offset) const {
     auto it = additionalBuffers.find(location);
     if (it != std::end(additionalBuffers)) {
-        return it->second == theBuffer;
+        return it->second.buffer == theBuffer && it->second.offset == offset;
     }
     return false;
 }
@@ -82,37 +156,28 @@ void VertexArrayObject::configureVertexAttributes(Shader& shader) {
     vbo->bind();
     GL_CHECK();
 
-    if (const AttributeLocation positionLocation =
-              shader.getAttributeLocation(positionAttributeName)) {
-        glVertexAttribPointer(positionLocation, sizeof(Point) / sizeof(float),
-                              GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                              (GLvoid*)offsetof(Vertex, position));
-        glEnableVertexAttribArray(positionLocation);
-        GL_CHECK();
-    }
-    if (const AttributeLocation normalLocation =
-              shader.getAttributeLocation(normalAttributeName)) {
-        glVertexAttribPointer(normalLocation, sizeof(Normal) / sizeof(float),
-                              GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                              (GLvoid*)offsetof(Vertex, normal));
-        glEnableVertexAttribArray(normalLocation);
-        GL_CHECK();
-    }
-    if (const AttributeLocation texCoordLocation =
-              shader.getAttributeLocation(texCoordAttributeName)) {
-        glVertexAttribPointer(texCoordLocation, sizeof(Point2D) / sizeof(float),
-                              GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                              (GLvoid*)offsetof(Vertex, texCoord));
-        glEnableVertexAttribArray(texCoordLocation);
-        GL_CHECK();
+    bool hasColor = false;
+    for (std::size_t i = 0; i < layout.attributeCount; ++i) {
+        const auto& attribute = layout.attributes[i];
+        if (const AttributeLocation location =
+                  shader.getAttributeLocation(attribute.name)) {
+            glVertexAttribPointer(location, attribute.size, attribute.type,
+                                  attribute.normalized ? GL_TRUE : GL_FALSE,
+                                  layout.stride, (GLvoid*)attribute.offset);
+            glEnableVertexAttribArray(location);
+            GL_CHECK();
+        }
+        hasColor |= std::strcmp(attribute.name, colorAttributeName) == 0;
     }
-    if (const AttributeLocation colorLocation =
-              shader.getAttributeLocation(colorAttributeName)) {
-        glVertexAttribPointer(colorLocation, sizeof(Color) / sizeof(float),
-                              GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                              (GLvoid*)offsetof(Vertex, color));
-        glEnableVertexAttribArray(colorLocation);
-        GL_CHECK();
+    if (!hasColor) {
+        // a disabled attribute reads the context's current value for its
+        // location rather than anything in the VAO. nothing else sets the
+        // color's, so setting it once means colorless vertices read white.
+        if (const AttributeLocation colorLocation =
+                  shader.getAttributeLocation(colorAttributeName)) {
+            glVertexAttrib4f(colorLocation, 1.f, 1.f, 1.f, 1.f);
+            GL_CHECK();
+        }
     }
     GL_CHECK();
 }
@@ -5,6 +5,8 @@
 #include "gl/buffer.hpp"
 #include "gl/gl.hpp"
 #include "gl/gl_object.hpp"
+#include "gl/mesh_registry.hpp"
+#include "gl/vertex_layout.hpp"
 
 #include <memory>
 #include <string>
@@ -17,14 +19,16 @@ class Shader;
 namespace detail {
 struct BindVAO {
     static void bind(GLuint buf) noexcept {
-        GL_CHECK(glBindVertexArray(buf));
-        assert(glIsVertexArray(buf));
+        GL::state::bindVertexArray(buf);
+        assert(buf == 0 || glIsVertexArray(buf));
     }
+    static GLuint current() noexcept { return GL::state::getVertexArray(); }
 };
 struct DeleteVAO {
     void operator()(GLuint vao) const noexcept {
         assert(glIsVertexArray(vao));
         glDeleteVertexArrays(1, &vao);
+        GL::state::vertexArrayDeleted(vao);
     }
 };
 }  // namespace detail
@@ -35,20 +39,60 @@ struct VertexArrayObject : public GLObject<detail::BindVAO, detail::DeleteVAO> {
             : runtime_error{"no attribute named \"" + name + '"'} {}
     };
 
-    VertexArrayObject(std::shared_ptr<VertexBuffer> in_vbo, Shader& shader);
+    // the attributes are set up from the vertex type's VertexLayout. the
+    // vertex count is taken now, so the vertices shouldn't change size later.
+    template <typename V>
+    VertexArrayObject(std::shared_ptr<VertexAttributeBuffer<V>> in_vbo,
+                      Shader& shader)
+        : VertexArrayObject{std::move(in_vbo), nullptr, shader} {}
+    // the index buffer may be null
+    template <typename V>
+    VertexArrayObject(std::shared_ptr<VertexAttributeBuffer<V>> in_vbo,
+                      std::shared_ptr<IndexBuffer> in_ibo,
+                      Shader& shader)
+        : VertexArrayObject{in_vbo, in_vbo->getElementCount(),
+                            VertexLayout<V>::describe(), std::move(in_ibo),
+                            shader} {}
+    template <typename V>
+    VertexArrayObject(const MeshRegistry::IndexedMesh<V>& mesh, Shader& shader)
+        : VertexArrayObject{mesh.vertices, mesh.indices, shader} {}
+    // shares another VAO's vertices and indices, set up for a different shader
+    VertexArrayObject(const VertexArrayObject& source, Shader& shader);
+    // for vertices in a buffer of no particular vertex type, laid out as
+    // described. the vertex count is only used if there are no indices.
+    VertexArrayObject(std::shared_ptr<VertexAttributeBuffer_base> in_vbo,
+                      std::size_t in_vertexCount,
+                      VertexLayoutDescription in_layout,
+                      std::shared_ptr<IndexBuffer> in_ibo,
+                      Shader& shader);
 
-    const VertexBuffer& getBuffer() const noexcept {
+    const VertexAttributeBuffer_base& getBuffer() const noexcept {
         assert(vbo);
         return *vbo;
     }
+    const std::shared_ptr<VertexAttributeBuffer_base>& getSharedBuffer() const
+          noexcept {
+        return vbo;
+    }
+    std::size_t getVertexCount() const noexcept { return vertexCount; }
+    const VertexLayoutDescription& getLayout() const noexcept { return layout; }
+    // null if the vertices aren't indexed
+    const std::shared_ptr<IndexBuffer>& getIndexBuffer() const noexcept {
+        return ibo;
+    }
+
+    // draws every vertex, or every index if there are any
+    void draw(GLenum mode = GL_TRIANGLES);
+    void drawInstanced(GLsizei instanceCount, GLenum mode = GL_TRIANGLES);
 
     void addBuffer(const std::string& attribute,
                    Shader& shader,
                    std::shared_ptr<VertexAttributeBuffer_base> theBuffer,
                    GLsizei size,
-                   GLsizei stride) noexcept(false) {
+                   GLsizei stride,
+                   std::size_t offset = 0) noexcept(false) {
         addInstancedBuffer(attribute, shader, std::move(theBuffer), size,
-                           stride, 0);
+                           stride, offset, 0);
     }
     template <typename T>
     void addBuffer(const std::string& attribute,
@@ -63,6 +107,7 @@ struct VertexArrayObject : public GLObject<detail::BindVAO, detail::DeleteVAO> {
           std::shared_ptr<VertexAttributeBuffer_base> theBuffer,
           GLsizei size,
           GLsizei stride,
+          std::size_t offset = 0,
           GLuint divisor = 1) noexcept(false);
     template <typename T>
     void addInstancedBuffer(
@@ -71,17 +116,45 @@ struct VertexArrayObject : public GLObject<detail::BindVAO, detail::DeleteVAO> {
           const std::shared_ptr<VertexAttributeBuffer<T>>& theBuffer,
           GLuint divisor = 1) {
         addInstancedBuffer(attribute, shader, theBuffer,
-                           sizeof(T) / sizeof(float), sizeof(T), divisor);
+                           sizeof(T) / sizeof(float), sizeof(T), 0, divisor);
     }
+    // a matrix attribute takes up one location per column. adding the same
+    // buffer again at a different offset moves the attribute there, e.g. to
+    // wherever this frame's instances were written in a StreamBuffer.
+    void addInstancedMatrix(
+          const std::string& attribute,
+          Shader& shader,
+          std::shared_ptr<VertexAttributeBuffer_base> theBuffer,
+          GLsizei columns,
+          GLsizei rows,
+          GLsizei stride,
+          std::size_t offset = 0,
+          GLuint divisor = 1) noexcept(false);
 
    private:
     void configureVertexAttributes(Shader& shader);
+    GLuint getAttributeLocation(const std::string& attribute,
+                                Shader& shader) const;
+    void setAttributePointer(
+          GLuint location,
+          std::shared_ptr<VertexAttributeBuffer_base> theBuffer,
+          GLsizei size,
+          GLsizei stride,
+          std::size_t offset,
+          GLuint divisor);
     bool isBufferAlreadySet(
           GLuint location,
-          const std::shared_ptr<VertexAttributeBuffer_base>& theBuffer) const;
-    std::shared_ptr<VertexBuffer> vbo;
-    std::unordered_map<GLuint, std::shared_ptr<VertexAttributeBuffer_base>>
-          additionalBuffers;
+          const std::shared_ptr<VertexAttributeBuffer_base>& theBuffer,
+          std::size_t offset) const;
+    std::shared_ptr<VertexAttributeBuffer_base> vbo;
+    std::size_t vertexCount;
+    VertexLayoutDescription layout;
+    std::shared_ptr<IndexBuffer> ibo;
+    struct AttributeSource {
+        std::shared_ptr<VertexAttributeBuffer_base> buffer;
+        std::size_t offset;
+    };
+    std::unordered_map<GLuint, AttributeSource> additionalBuffers;
 };
 
 NS_KEPLER_END
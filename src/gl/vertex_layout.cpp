@@ -0,0 +1,100 @@
+#include "gl/vertex_layout.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+NS_KEPLER_BEGIN
+
+namespace {
+template <std::size_t N>
+VertexLayoutDescription makeDescription(
+      const std::array<VertexAttribute, N>& attributes,
+      std::size_t stride) {
+    return {attributes.data(), attributes.size(), stride};
+}
+}  // namespace
+
+VertexLayoutDescription VertexLayout<Vertex>::describe() {
+    static const std::array<VertexAttribute, 4> attributes{{
+          {"position", 3, GL_FLOAT, false, offsetof(Vertex, position)},
+          {"normal", 3, GL_FLOAT, false, offsetof(Vertex, normal)},
+          {"texCoord", 2, GL_FLOAT, false, offsetof(Vertex, texCoord)},
+          {"color", 4, GL_FLOAT, false, offsetof(Vertex, color)},
+    }};
+    return makeDescription(attributes, sizeof(Vertex));
+}
+
+VertexLayoutDescription VertexLayout<CompactVertex>::describe() {
+    static const std::array<VertexAttribute, 3> attributes{{
+          {"position", 3, GL_FLOAT, false, offsetof(CompactVertex, position)},
+          {"normal", 4, GL_INT_2_10_10_10_REV, true,
+           offsetof(CompactVertex, normal)},
+          {"texCoord", 2, GL_HALF_FLOAT, false,
+           offsetof(CompactVertex, texCoord)},
+    }};
+    return makeDescription(attributes, sizeof(CompactVertex));
+}
+
+CompactVertex VertexLayout<CompactVertex>::fromVertex(const Vertex& v) {
+    return {v.position, packing::snorm10x3(v.normal.rep()),
+            {{packing::half(v.texCoord.rep().x),
+              packing::half(v.texCoord.rep().y)}}};
+}
+
+namespace packing {
+std::uint32_t snorm10x3(const glm::vec3& v) {
+    std::uint32_t packed = 0;
+    for (int i = 0; i < 3; ++i) {
+        const auto clamped = std::min(std::max(v[i], -1.f), 1.f);
+        const auto scaled =
+              static_cast<std::int32_t>(std::round(clamped * 511.f));
+        packed |= (static_cast<std::uint32_t>(scaled) & 0x3ffu) << (10 * i);
+    }
+    return packed;
+}
+
+std::uint16_t half(float f) {
+    std::uint32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+    const std::uint32_t sign = (bits >> 16) & 0x8000u;
+    const std::uint32_t floatExponent = (bits >> 23) & 0xffu;
+    std::uint32_t mantissa = bits & 0x7fffffu;
+
+    if (floatExponent == 0xffu) {
+        // infinity stays infinity, and NaN stays NaN
+        return static_cast<std::uint16_t>(sign | 0x7c00u |
+                                          (mantissa ? 0x200u : 0u));
+    }
+    const int exponent = static_cast<int>(floatExponent) - 127 + 15;
+    if (exponent >= 0x1f) {
+        return static_cast<std::uint16_t>(sign | 0x7c00u);
+    }
+    if (exponent <= 0) {
+        // too small for a normal half, but maybe not for a denormal one
+        if (exponent < -10) {
+            return static_cast<std::uint16_t>(sign);
+        }
+        mantissa |= 0x800000u;
+        const auto shift = static_cast<std::uint32_t>(14 - exponent);
+        std::uint32_t result = mantissa >> shift;
+        const auto remainder = mantissa & ((1u << shift) - 1);
+        const auto halfway = 1u << (shift - 1);
+        if (remainder > halfway || (remainder == halfway && (result & 1u))) {
+            ++result;
+        }
+        return static_cast<std::uint16_t>(sign | result);
+    }
+    std::uint32_t result = sign |
+                           (static_cast<std::uint32_t>(exponent) << 10) |
+                           (mantissa >> 13);
+    // ties to even. a carry out of the mantissa correctly bumps the exponent.
+    const auto remainder = mantissa & 0x1fffu;
+    if (remainder > 0x1000u || (remainder == 0x1000u && (result & 1u))) {
+        ++result;
+    }
+    return static_cast<std::uint16_t>(result);
+}
+}  // namespace packing
+
+NS_KEPLER_END
@@ -0,0 +1,68 @@
+#ifndef VERTEX_LAYOUT_HPP
+#define VERTEX_LAYOUT_HPP
+
+#include "common/types.hpp"
+#include "gl/gl.hpp"
+#include "kepler_config.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+NS_KEPLER_BEGIN
+
+// one attribute of an interleaved vertex, as glVertexAttribPointer sees it
+struct VertexAttribute {
+    const char* name;
+    GLint size;
+    GLenum type;
+    bool normalized;
+    std::size_t offset;
+};
+
+// the view of a vertex layout a VertexArrayObject needs. the attributes live
+// for the whole program.
+struct VertexLayoutDescription {
+    const VertexAttribute* attributes;
+    std::size_t attributeCount;
+    std::size_t stride;
+};
+
+// specialized for each vertex type that can go in a VertexAttributeBuffer
+// and be drawn with a VertexArrayObject:
+//     static VertexLayoutDescription describe();
+//     static V fromVertex(const Vertex& v);
+template <typename V>
+struct VertexLayout;
+
+template <>
+struct VertexLayout<Vertex> {
+    static VertexLayoutDescription describe();
+    static Vertex fromVertex(const Vertex& v) { return v; }
+};
+
+// a vertex less than half the size of Vertex, for meshes where vertex
+// bandwidth matters. the normal is packed 10-10-10-2, the texture coordinates
+// are half floats, and there's no color: shaders see white instead.
+struct CompactVertex {
+    Point position;
+    std::uint32_t normal;
+    std::array<std::uint16_t, 2> texCoord;
+};
+
+template <>
+struct VertexLayout<CompactVertex> {
+    static VertexLayoutDescription describe();
+    static CompactVertex fromVertex(const Vertex& v);
+};
+
+namespace packing {
+// as GL_INT_2_10_10_10_REV, with w = 0
+std::uint32_t snorm10x3(const glm::vec3& v);
+// as GL_HALF_FLOAT, rounding to nearest
+std::uint16_t half(float f);
+}  // namespace packing
+
+NS_KEPLER_END
+
+#endif
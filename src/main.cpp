@@ -2,13 +2,16 @@
 
 #include "common/common.hpp"
 #include "common/types.hpp"
-#include "data/cube.hpp"
 #include "data/fs.hpp"
 #include "data/image.hpp"
 #include "gl/binding.hpp"
 #include "gl/buffer.hpp"
 #include "gl/gl.hpp"
+#include "gl/gpu_profiler.hpp"
+#include "gl/mesh_registry.hpp"
+#include "gl/program_cache.hpp"
 #include "gl/shader.hpp"
+#include "gl/state.hpp"
 #include "gl/texture.hpp"
 #include "gl/vertex_array.hpp"
 #include "kepler_config.hpp"
@@ -17,12 +20,14 @@
 #include "renderer/renderer.hpp"
 #include "scene/behaviors.hpp"
 #include "scene/camera.hpp"
+#include "scene/camera_path.hpp"
+#include "scene/demo_scene.hpp"
 #include "scene/light.hpp"
 #include "scene/material.hpp"
 #include "scene/object.hpp"
 #include "scene/scene.hpp"
 #include "util/optional.hpp"
-#include "util/random.hpp"
+#include "util/trace.hpp"
 #include "window/input.hpp"
 #include "window/window.hpp"
 
@@ -34,21 +39,58 @@ USING_NS_KEPLER;
 namespace {
 struct FPSTimer {
     FPSTimer(Seconds freq) : printFrequency{freq}, frames{0}, seconds{0.f} {}
-    void update(Seconds dt) {
+    void update(Seconds dt,
+                const GL::state::Stats& stats,
+                const SceneCuller::Stats& culling,
+                const ObjectBatcher::Stats& batching,
+                const StreamBuffer::Stats& streaming) {
         ++frames;
         seconds.rep() += dt.rep();
         if (seconds.rep() > printFrequency.rep()) {
-            printFPS();
+            printFPS(stats, culling, batching, streaming);
         }
     }
-    void printFPS() {
+    void printFPS(const GL::state::Stats& stats,
+                  const SceneCuller::Stats& culling,
+                  const ObjectBatcher::Stats& batching,
+                  const StreamBuffer::Stats& streaming) {
         std::cout << "fps: " << static_cast<float>(frames) / seconds.rep()
-                  << '\n';
+                  << " (gl state changes: " << stats.issued << ", "
+                  << stats.filtered << " redundant ones filtered)\n"
+                  << "     objects drawn: " << culling.objectsSubmitted
+                  << ", culled: " << culling.objectsCulled
+                  << "; point lights drawn: " << culling.pointLightsSubmitted
+                  << ", culled: " << culling.pointLightsCulled << '\n'
+                  << "     geometry draw calls: " << batching.drawCalls
+                  << " (" << batching.instancedObjects
+                  << " objects instanced, " << batching.indirectDraws
+                  << " indirect draws)\n"
+                  << "     streamed: " << streaming.bytesWritten
+                  << " bytes (" << streaming.waits << " waits, "
+                  << streaming.orphans << " orphans)\n";
+        printGPUTimes();
         frames = 0;
         seconds = {};
     }
 
    private:
+    // the top-level passes' averages
+    void printGPUTimes() {
+        const auto stats = GPUProfiler::getStats();
+        if (stats.passes.empty()) {
+            return;
+        }
+        std::cout << "     gpu ms:";
+        for (const auto& pass : stats.passes) {
+            if (pass.depth <= 1) {
+                const auto name =
+                      pass.path.substr(pass.path.rfind('/') + 1);
+                std::cout << ' ' << name << ' ' << pass.average;
+            }
+        }
+        std::cout << '\n';
+    }
+
     Seconds printFrequency;
     int frames;
     Seconds seconds;
@@ -58,14 +100,6 @@ void errorCallback(int error, const char* description) {
     std::cerr << "GLFW error " << error << ": " << description << '\n';
 }
 
-template <typename T, std::size_t N>
-std::vector<T> toVec(const std::array<T, N>& arr) {
-    std::vector<T> vec;
-    vec.reserve(N);
-    std::copy(std::begin(arr), std::end(arr), std::back_inserter(vec));
-    return vec;
-}
-
 std::unique_ptr<Camera> createCamera(Window& window) {
     std::unique_ptr<Camera> camera =
           std::make_unique<PerspectiveCamera>(window.getResolution());
@@ -129,85 +163,54 @@ std::unique_ptr<Camera> createCamera(Window& window) {
     return camera;
 }
 
-Object randomCube(const Object& startingCube) {
-    using util::random;
-    Object ret = startingCube;
-    ret.transform().position =
-          Point{random(-5.f, 5.f), random(-5.f, 5.f), random(-10.f, 0.f)};
-    ret.transform().scale = Scale{random(0.5f, 1.5f)};
-    if (util::randomBool()) {
-        ret.addBehavior(RotateForeverBehavior{
-              Euler{Degrees{random(-5.f, 5.f)}, Degrees{random(-5.f, 5.f)},
-                    Degrees{random(-5.f, 5.f)}}});
-    }
-    return ret;
+PostprocessingPipeline getPostprocessingPipeline() {
+    auto gamma = std::make_unique<SimplePostprocessingStep>(
+          std::vector<SimplePostprocessingStep::StepDescriptor>{
+                {"gamma_correction"},
+          });
+    return gamma;
 }
 
-Object theFloor() {
-    Texture::Params params;
-    params.wrapS = params.wrapT = Texture::Wrap::Repeat;
-    auto containerTexture = std::make_shared<Texture>(
-          Image{fs::RelativePath{"res/tiles_016_basecolor.jpg"}}, true, params);
-    auto containerSpecularTexture = std::make_shared<Texture>(
-          Image{fs::RelativePath{"res/tiles_016_roughness.jpg"}}, false,
-          params);
-    const Material floorMaterial{containerTexture, containerSpecularTexture,
-                                 256.f};
-
-    constexpr auto size = 20.f;
-    auto verts = {
-          Vertex{{-1.f, 0.f, -1.f}, {0.f, 1.f, 0.f}, {0.f, 0.f}, {}},
-          Vertex{{-1.f, 0.f, +1.f}, {0.f, 1.f, 0.f}, {size, 0.f}, {}},
-          Vertex{{+1.f, 0.f, -1.f}, {0.f, 1.f, 0.f}, {0.f, size}, {}},
-          Vertex{{+1.f, 0.f, -1.f}, {0.f, 1.f, 0.f}, {0.f, size}, {}},
-          Vertex{{-1.f, 0.f, +1.f}, {0.f, 1.f, 0.f}, {size, 0.f}, {}},
-          Vertex{{+1.f, 0.f, +1.f}, {0.f, 1.f, 0.f}, {size, size}, {}},
-    };
+// G cycles through these, starting from the first
+struct TargetFormatPreset {
+    const char* name;
+    Renderer::TargetFormats formats;
+};
+std::vector<TargetFormatPreset> getTargetFormatPresets() {
+    using Layout = GBuffer::Layout;
+    auto full = Renderer::TargetFormats::defaults(Layout::Full);
+    auto fullHDR = full;
+    fullHDR.postprocessing = Texture::ColorFormat::RGBA16F;
+    auto compact = Renderer::TargetFormats::defaults(Layout::Compact);
+    auto compactHDR = compact;
+    compactHDR.postprocessing = Texture::ColorFormat::R11G11B10F;
+    auto compact10 = compact;
+    compact10.gBuffer[0] = Texture::ColorFormat::RGB10A2;
+    compact10.gBuffer[GBuffer::Target::Diffuse] =
+          Texture::ColorFormat::RGB10A2;
     return {
-          Transform{Point{0.f, -2.f, 0.f}, Euler{}, Scale{size, 1.f, size}},
-          verts,
-          floorMaterial,
+          {"full", full},
+          {"full, HDR", fullHDR},
+          {"compact", compact},
+          {"compact, HDR", compactHDR},
+          {"compact, 10-bit", compact10},
     };
 }
 
-PointLight randomLight() {
-    using util::random;
-    constexpr auto areaSize = 10.f;
-    constexpr auto areaVertOffset = 5.f;
-    auto randomPoint = [&] {
-        return Point{random(-areaSize, areaSize),
-                     random(-areaSize, areaSize) + areaVertOffset,
-                     random(-areaSize, areaSize)};
-    };
-    auto randomColor = [&] {
-        return ColorRGB{util::randomOnUnitSphere() * 0.333f +
-                        glm::vec3{0.667f}};
-    };
-    const auto lightColor = randomColor();
-    auto theLight = PointLight{
-          Transform{randomPoint(), Euler{}, Scale{2.5f}},
-          Light_base::Colors{ColorRGB{0.1f, 0.1f, 0.1f}, lightColor,
-                             lightColor},
-          PointLight::Radius{random(2.5f, 7.5f)},
-    };
-    if (util::randomBool(0.2f)) {
-        theLight.addBehavior(PulseBehavior{random(0.f, 2.f)});
+void printTargetFormats(const TargetFormatPreset& preset,
+                        Resolution resolution) {
+    const auto bytes = preset.formats.getBytesPerPixel();
+    const auto pixels = static_cast<std::size_t>(resolution.width()) *
+                        static_cast<std::size_t>(resolution.height());
+    std::cout << preset.name << ": G-buffer";
+    for (const auto format : preset.formats.gBuffer) {
+        std::cout << ' ' << Texture::getName(format);
     }
-    return theLight;
-}
-auto getRandomLights(std::size_t count) {
-    std::vector<PointLight> lights;
-    lights.reserve(count);
-    std::generate_n(std::back_inserter(lights), count, randomLight);
-    return lights;
-}
-
-PostprocessingPipeline getPostprocessingPipeline() {
-    auto gamma = std::make_unique<SimplePostprocessingStep>(
-          std::vector<SimplePostprocessingStep::StepDescriptor>{
-                {"gamma_correction"},
-          });
-    return gamma;
+    std::cout << ", postprocessing "
+              << Texture::getName(preset.formats.postprocessing) << "; "
+              << bytes << " bytes per pixel, "
+              << bytes * pixels / (1024.f * 1024.f) << " MiB at "
+              << resolution << '\n';
 }
 }  // namespace
 
@@ -218,28 +221,12 @@ int main() {
     window.getInput().setKeyCallback(Input::Key::Esc,
                                      [&] { window.requestClose(); });
 
-    auto containerTexture = std::make_shared<Texture>(
-          Image{fs::RelativePath{"res/container2.png"}}, true);
-    auto containerSpecularTexture = std::make_shared<Texture>(
-          Image{fs::RelativePath{"res/container2_specular.png"}}, false);
-    assert(glGetError() == GL_NO_ERROR);
-
-    auto cubeBuffer = std::make_shared<VertexBuffer>(getCubeVerts());
-    GL_CHECK();
-
-    PointLight light{
-          {Point{1.f, 1.f, -1.f}, Euler{}, Scale{0.5f}},
-          {{0.1f, 0.1f, 0.1f}, {1.f, 0.5f, 1.f}, {1.f, 0.5f, 1.f}},
-          PointLight::Radius{5.f},
-    };
-    PointLight light2{
-          {Point{1.f, -1.f, -10.f}, Euler{}, Scale{0.5f}},
-          {{0.1f, 0.1f, 0.1f}, {0.f, 0.5f, 1.f}, {0.f, 0.5f, 1.f}},
-          PointLight::Radius{5.f},
-    };
-    const Material cubeMaterial{containerTexture, containerSpecularTexture,
-                                512.f};
-    GL_CHECK();
+    // programs built by earlier runs are loaded from here, not compiled again
+    try {
+        ProgramCache::open(fs::RelativePath{"program_cache.bin"});
+    } catch (const fs::error_opening_file& e) {
+        std::cerr << e.what() << ", so programs won't be cached\n";
+    }
 
     Renderer theRenderer{window.getResolution(), createCamera(window),
                          getPostprocessingPipeline()};
@@ -249,25 +236,36 @@ int main() {
         theRenderer.debug_cycleDeferredTechnique();
     });
 
-    Object cube{Transform{Point{0.f, 1.f, -4.f},
-                          Euler{Degrees{0.f}, Degrees{0.f}, Degrees{0.f}},
-                          Scale{1.f, 1.f, 1.f}},
-                toVec(getCubeVerts()), cubeMaterial};
-    GL_CHECK();
-
-    static constexpr auto numberOfCubes = 200;
-    std::vector<Object> cubes{cube};
-    cubes.reserve(1 + numberOfCubes);
-    std::generate_n(std::back_inserter(cubes), numberOfCubes,
-                    [&] { return randomCube(cube); });
+    const auto targetFormatPresets = getTargetFormatPresets();
+    std::cout << "render target formats (depth included):\n";
+    for (const auto& preset : targetFormatPresets) {
+        printTargetFormats(preset, window.getResolution());
+    }
+    std::size_t currentPreset = 0;
+    window.getInput().setKeyCallback(Input::Key::G, [&] {
+        currentPreset = (currentPreset + 1) % targetFormatPresets.size();
+        const auto& preset = targetFormatPresets[currentPreset];
+        theRenderer.setTargetFormats(preset.formats);
+        std::cout << "switched render targets to ";
+        printTargetFormats(preset, window.getResolution());
+    });
 
-    static constexpr auto numberOfPointLights = 63;
+    auto mainScene = makeDemoScene();
 
-    Scene mainScene{std::move(cubes), getRandomLights(numberOfPointLights), {}};
-    mainScene.addObject(theFloor());
-    mainScene.addDirectionalLight(DirectionalLight{
-          Direction{0.f, -1.f, 0.f},
-          {{0.f, 0.f, 0.f}, {0.05f, 0.05f, 0.05f}, {0.1f, 0.05f, 0.05f}}});
+    const auto meshStats = MeshRegistry::getStats();
+    std::cout << "vertex data: " << meshStats.meshes << " meshes, "
+              << meshStats.residentBytes / 1024 << " KiB resident ("
+              << meshStats.sharedRequests << " uploads shared, saving "
+              << meshStats.sharedBytes / 1024 << " KiB); vertex cache ACMR "
+              << meshStats.acmrBefore << " -> " << meshStats.acmrAfter
+              << '\n';
+    if (ProgramCache::isOpen()) {
+        const auto programStats = ProgramCache::getStats();
+        std::cout << "programs: " << programStats.hits
+                  << " loaded from the cache, " << programStats.misses
+                  << " compiled (" << programStats.rejected
+                  << " cached ones rejected by the driver)\n";
+    }
 
     window.setWindowSizeCallback([&](const Resolution newResolution) {
         std::cout << "window size changed to " << newResolution << '\n';
@@ -276,14 +274,68 @@ int main() {
 
     FPSTimer timer{1.f};
 
+    // T captures a few seconds of frames for chrome://tracing
+    window.getInput().setKeyCallback(Input::Key::T, [] {
+        if (!trace::isCapturing()) {
+            std::cout << "capturing a trace...\n";
+            trace::captureFrames(300);
+        }
+    });
+
+    // R records the camera's path, for kepler_bench to fly, until the window
+    // closes
+    CameraPath cameraPath;
+    bool recordingCameraPath = false;
+    window.getInput().setKeyCallback(Input::Key::R, [&] {
+        if (!recordingCameraPath) {
+            std::cout << "recording the camera path...\n";
+            cameraPath.clear();
+            recordingCameraPath = true;
+        }
+    });
+    Seconds recordingTime{0.f};
+    constexpr auto keyframeInterval = 0.1f;
+
+    // saving a shader's files rebuilds the programs made from them
+    Shader::startWatching();
+
     while (!window.shouldClose()) {
-        mainScene.update(window.getDeltaTime());
-        theRenderer.renderScene(mainScene);
-        timer.update(window.getDeltaTime());
+        Shader::updateReloads();
+        if (recordingCameraPath) {
+            if (cameraPath.empty() ||
+                recordingTime.rep() - cameraPath.getDuration().rep() >=
+                      keyframeInterval) {
+                cameraPath.addKeyframe(recordingTime,
+                                       theRenderer.getCamera().transform());
+            }
+            recordingTime.rep() += window.getDeltaTime().rep();
+        }
+        mainScene->update(window.getDeltaTime());
+        theRenderer.renderScene(*mainScene);
+        timer.update(window.getDeltaTime(),
+                     theRenderer.getLastFrameStateStats(),
+                     theRenderer.getLastFrameCullingStats(),
+                     theRenderer.getLastFrameBatchingStats(),
+                     theRenderer.getLastFrameStreamingStats());
         window.update();
+        if (trace::markFrame()) {
+            const fs::AbsolutePath path = fs::RelativePath{"trace.json"};
+            trace::writeJSON(path);
+            std::cout << "trace written to " << path.get() << '\n';
+        }
     }
 
+    if (recordingCameraPath) {
+        const fs::AbsolutePath path = fs::RelativePath{"camera.path"};
+        cameraPath.save(path);
+        std::cout << "camera path written to " << path.get() << '\n';
+    }
+    GPUProfiler::flush();
+    GPUProfiler::writeReport(fs::RelativePath{"gpu_profile.txt"});
+    GPUProfiler::clear();
+    Shader::stopWatching();
     Shader::clearCache();
+    ProgramCache::close();
 
     return 0;
 }
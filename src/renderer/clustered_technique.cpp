@@ -0,0 +1,240 @@
+#include "renderer/clustered_technique.hpp"
+#include "common/types.hpp"
+#include "gl/binding.hpp"
+#include "gl/gl.hpp"
+#include "gl/gpu_profiler.hpp"
+#include "gl/mesh_registry.hpp"
+#include "renderer/culling.hpp"
+#include "renderer/frame_uniforms.hpp"
+#include "renderer/gbuffer.hpp"
+#include "scene/scene.hpp"
+#include "util/trace.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+NS_KEPLER_BEGIN
+
+constexpr int ClusteredTechnique::ClustersX;
+constexpr int ClusteredTechnique::ClustersY;
+constexpr int ClusteredTechnique::ClustersZ;
+constexpr std::size_t ClusteredTechnique::MaxLightsPerCluster;
+
+namespace {
+// the G-buffer takes the first few units
+struct TextureUnit {
+    enum {
+        PointLights = GBuffer::DepthTarget + 1,
+        Clusters,
+        ClusterLightIndices,
+    };
+    TextureUnit() = delete;
+};
+
+constexpr int clusterCount = ClusteredTechnique::ClustersX *
+                             ClusteredTechnique::ClustersY *
+                             ClusteredTechnique::ClustersZ;
+
+int clusterIndex(int x, int y, int z) {
+    return x + ClusteredTechnique::ClustersX *
+                     (y + ClusteredTechnique::ClustersY * z);
+}
+
+// which of count equal divisions of [-1, 1] the coordinate falls in
+int tileOf(float ndc, int count) {
+    const auto tile = static_cast<int>(std::floor((ndc * .5f + .5f) * count));
+    return glm::clamp(tile, 0, count - 1);
+}
+
+std::array<Vertex, 6> getFullScreenQuad() {
+    return {{
+          {{-1.f, -1.f, 0.f}, {}, {0.f, 0.f}, {}},
+          {{1.f, -1.f, 0.f}, {}, {1.f, 0.f}, {}},
+          {{-1.f, 1.f, 0.f}, {}, {0.f, 1.f}, {}},
+          {{1.f, -1.f, 0.f}, {}, {1.f, 0.f}, {}},
+          {{1.f, 1.f, 0.f}, {}, {1.f, 1.f}, {}},
+          {{-1.f, 1.f, 0.f}, {}, {0.f, 1.f}, {}},
+    }};
+}
+}  // namespace
+
+ClusteredTechnique::ClusteredTechnique()
+    : shader{Shader::compileReloadable([] {
+        return GBuffer::shaderSources(
+              fs::RelativePath("shaders/position.vert"),
+              fs::RelativePath("shaders/clustered.frag"));
+    }).take()}
+    , fullscreenQuad{MeshRegistry::get(getFullScreenQuad()),
+                     shader}
+    , pointLightTexels{GL_RGBA32F}
+    , clusterTexels{GL_RG32UI}
+    , lightIndexTexels{GL_R32UI}
+    , zNear{0.f}
+    , zFar{0.f} {
+    // directional lights come from the frame's Lights block
+    FrameUniforms::bindBlocks(shader);
+}
+
+bool ClusteredTechnique::blitsGBufferDepth() const {
+    return false;
+}
+
+void ClusteredTechnique::doDeferredPass(GBuffer& gBuffer,
+                                        FrameBuffer::View outputFrameBuffer,
+                                        Scene& scene,
+                                        const VisibleSet& visible,
+                                        const glm::mat4& viewTransform,
+                                        const glm::mat4& projectionTransform,
+                                        const Resolution resolution) {
+    GL::ScopedDisable<GL::DepthTest> noDepthTest;
+
+    {
+        trace::Scope trace{"light assignment"};
+        assignLights(scene, visible, viewTransform, projectionTransform);
+    }
+    {
+        GPUProfiler::Scope profile{"light upload"};
+        uploadLights();
+    }
+    setUniforms(gBuffer, resolution);
+
+    GPUProfiler::Scope profile{"shading"};
+    outputFrameBuffer.bind();
+    glClearColor(0.f, 0.f, 0.f, 0.f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    RAIIBinding<VertexArrayObject> bind{fullscreenQuad};
+    glDrawArrays(GL_TRIANGLES, 0, fullscreenQuad.getVertexCount());
+}
+
+void ClusteredTechnique::assignLights(Scene& scene,
+                                      const VisibleSet& visible,
+                                      const glm::mat4& viewTransform,
+                                      const glm::mat4& projectionTransform) {
+    // kepler's cameras are all perspective, so the clip planes can be
+    // recovered from the projection
+    const float a = projectionTransform[2][2];
+    const float b = projectionTransform[3][2];
+    zNear = b / (a - 1.f);
+    zFar = b / (a + 1.f);
+    const float logDepthRatio = std::log(zFar / zNear);
+    auto sliceOf = [&](float depth) {
+        const auto slice = static_cast<int>(
+              std::floor(std::log(depth / zNear) / logDepthRatio * ClustersZ));
+        return glm::clamp(slice, 0, ClustersZ - 1);
+    };
+
+    auto pointLights = scene.getPointLights();
+    pointLightData.clear();
+    lightRanges.clear();
+    clusterData.assign(clusterCount, glm::uvec2{0u});
+
+    // find the clusters each visible light's bounding box touches, and count
+    // how many lights each cluster gets
+    for (const auto index : visible.pointLights) {
+        const auto& light = pointLights[index];
+        const auto center = light.getViewPosition(viewTransform);
+        const auto radius = light.radius.rep();
+        pointLightData.emplace_back(center, radius);
+        pointLightData.emplace_back(light.colors.ambient.rep(), 0.f);
+        pointLightData.emplace_back(light.colors.diffuse.rep(), 0.f);
+        pointLightData.emplace_back(light.colors.specular.rep(), 0.f);
+
+        // view space looks down -z
+        const auto minDepth = std::max(-center.z - radius, zNear);
+        const auto maxDepth = std::min(-center.z + radius, zFar);
+        if (minDepth > maxDepth) {
+            lightRanges.push_back({0, -1, 0, -1, 0, -1});
+            continue;
+        }
+        // under a perspective projection, a box's screen-space extent is at
+        // its corners
+        glm::vec2 ndcMin{std::numeric_limits<float>::max()};
+        glm::vec2 ndcMax{std::numeric_limits<float>::lowest()};
+        for (const auto depth : {minDepth, maxDepth}) {
+            for (const auto dx : {-radius, radius}) {
+                for (const auto dy : {-radius, radius}) {
+                    const auto clip =
+                          projectionTransform *
+                          glm::vec4{center.x + dx, center.y + dy, -depth, 1.f};
+                    const auto ndc = glm::vec2{clip.x, clip.y} / clip.w;
+                    ndcMin = glm::min(ndcMin, ndc);
+                    ndcMax = glm::max(ndcMax, ndc);
+                }
+            }
+        }
+        if (ndcMax.x < -1.f || ndcMin.x > 1.f || ndcMax.y < -1.f ||
+            ndcMin.y > 1.f) {
+            lightRanges.push_back({0, -1, 0, -1, 0, -1});
+            continue;
+        }
+        const ClusterRange range{
+              tileOf(ndcMin.x, ClustersX), tileOf(ndcMax.x, ClustersX),
+              tileOf(ndcMin.y, ClustersY), tileOf(ndcMax.y, ClustersY),
+              sliceOf(minDepth),           sliceOf(maxDepth)};
+        lightRanges.push_back(range);
+        for (int z = range.minZ; z <= range.maxZ; ++z) {
+            for (int y = range.minY; y <= range.maxY; ++y) {
+                for (int x = range.minX; x <= range.maxX; ++x) {
+                    ++clusterData[clusterIndex(x, y, z)].y;
+                }
+            }
+        }
+    }
+
+    // lay the clusters' lists out back to back
+    GLuint offset = 0;
+    for (auto& cluster : clusterData) {
+        const auto count = std::min<GLuint>(cluster.y, MaxLightsPerCluster);
+        cluster = {offset, 0u};
+        offset += count;
+    }
+    lightIndices.resize(offset);
+
+    // and fill them in. each cluster's count doubles as its write cursor.
+    // lights are indexed in the order they were packed, not the scene's.
+    for (std::size_t i = 0; i < lightRanges.size(); ++i) {
+        const auto& range = lightRanges[i];
+        for (int z = range.minZ; z <= range.maxZ; ++z) {
+            for (int y = range.minY; y <= range.maxY; ++y) {
+                for (int x = range.minX; x <= range.maxX; ++x) {
+                    auto& cluster = clusterData[clusterIndex(x, y, z)];
+                    if (cluster.y < MaxLightsPerCluster) {
+                        lightIndices[cluster.x + cluster.y++] =
+                              static_cast<GLuint>(i);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void ClusteredTechnique::uploadLights() {
+    pointLightTexels.setData(pointLightData);
+    clusterTexels.setData(clusterData);
+    lightIndexTexels.setData(lightIndices);
+}
+
+void ClusteredTechnique::setUniforms(GBuffer& gBuffer,
+                                     const Resolution resolution) {
+    gBuffer.bindTextures(shader);
+
+    auto bindTexels = [&](const auto& name, TextureBuffer& texels, int unit) {
+        texels.bind(unit);
+        GL_CHECK(shader.setUniform(name, unit));
+    };
+    bindTexels("pointLights", pointLightTexels, TextureUnit::PointLights);
+    bindTexels("clusters", clusterTexels, TextureUnit::Clusters);
+    bindTexels("clusterLightIndices", lightIndexTexels,
+               TextureUnit::ClusterLightIndices);
+
+    shader.setUniform("clusterCounts",
+                      glm::ivec3{ClustersX, ClustersY, ClustersZ});
+    shader.setUniform("screenResolution", glm::vec2{resolution.rep()});
+    shader.setUniform("zNear", zNear);
+    shader.setUniform("clusterDepthScale",
+                      ClustersZ / std::log(zFar / zNear));
+}
+
+NS_KEPLER_END
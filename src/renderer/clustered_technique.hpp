@@ -0,0 +1,68 @@
+#ifndef CLUSTERED_TECHNIQUE_HPP
+#define CLUSTERED_TECHNIQUE_HPP
+
+#include "gl/shader.hpp"
+#include "gl/texture_buffer.hpp"
+#include "gl/vertex_array.hpp"
+#include "kepler_config.hpp"
+#include "renderer/deferred_shading_technique.hpp"
+
+#include <cstddef>
+#include <vector>
+
+NS_KEPLER_BEGIN
+
+// shades every pixel in one full-screen pass, like SimpleTechnique, but only
+// against the point lights that can reach it. the view frustum is cut into a
+// grid of clusters (screen-space tiles, sliced exponentially in depth), each
+// point light is binned into the clusters its bounds overlap on the CPU, and
+// the per-cluster light lists go to the shader in texture buffers.
+struct ClusteredTechnique final : public DeferredShadingTechnique {
+    ClusteredTechnique();
+    void doDeferredPass(GBuffer& gBuffer,
+                        FrameBuffer::View outputFrameBuffer,
+                        Scene& scene,
+                        const VisibleSet& visible,
+                        const glm::mat4& viewTransform,
+                        const glm::mat4& projectionTransform,
+                        const Resolution resolution) override;
+    bool blitsGBufferDepth() const override;
+
+    static constexpr int ClustersX = 16;
+    static constexpr int ClustersY = 9;
+    static constexpr int ClustersZ = 24;
+    // bounds the cost of shading any one pixel. lights past this many in a
+    // cluster are dropped from it.
+    static constexpr std::size_t MaxLightsPerCluster = 256;
+
+   private:
+    void assignLights(Scene& scene,
+                      const VisibleSet& visible,
+                      const glm::mat4& viewTransform,
+                      const glm::mat4& projectionTransform);
+    // what assignLights came up with, into the texture buffers
+    void uploadLights();
+    void setUniforms(GBuffer& gBuffer, const Resolution resolution);
+
+    struct ClusterRange {
+        int minX, maxX, minY, maxY, minZ, maxZ;
+    };
+
+   private:
+    Shader shader;
+    VertexArrayObject fullscreenQuad;
+
+    TextureBuffer pointLightTexels, clusterTexels, lightIndexTexels;
+
+    // kept between frames to save reallocating
+    std::vector<glm::vec4> pointLightData;
+    std::vector<ClusterRange> lightRanges;
+    std::vector<glm::uvec2> clusterData;
+    std::vector<GLuint> lightIndices;
+
+    float zNear, zFar;
+};
+
+NS_KEPLER_END
+
+#endif
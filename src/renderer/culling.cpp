@@ -0,0 +1,78 @@
+#include "renderer/culling.hpp"
+#include "scene/scene.hpp"
+
+#include <algorithm>
+
+NS_KEPLER_BEGIN
+
+void SphereBatch::clear() {
+    x.clear();
+    y.clear();
+    z.clear();
+    radius.clear();
+}
+
+void SphereBatch::add(const BoundingSphere& sphere) {
+    x.push_back(sphere.center.x);
+    y.push_back(sphere.center.y);
+    z.push_back(sphere.center.z);
+    radius.push_back(sphere.radius);
+}
+
+void SphereBatch::cull(const Frustum& frustum,
+                       std::vector<std::size_t>& visible) {
+    const auto count = size();
+    inside.assign(count, 1);
+    const float* const xs = x.data();
+    const float* const ys = y.data();
+    const float* const zs = z.data();
+    const float* const radii = radius.data();
+    std::uint8_t* const in = inside.data();
+    for (const auto& plane : frustum.getPlanes()) {
+        const auto a = plane.x, b = plane.y, c = plane.z, d = plane.w;
+        // no branches or early outs, so this vectorizes
+        for (std::size_t i = 0; i < count; ++i) {
+            in[i] &= (a * xs[i] + b * ys[i] + c * zs[i] + d >= -radii[i]);
+        }
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        if (in[i]) {
+            visible.push_back(i);
+        }
+    }
+}
+
+//
+
+void SceneCuller::cull(const Scene& scene,
+                       const Frustum& frustum,
+                       VisibleSet& visible) {
+    visible.objects.clear();
+    visible.pointLights.clear();
+
+    // the tree only knows the objects' padded bounds, so check the real ones
+    // before keeping anything it finds
+    const auto& objects = scene.getObjects();
+    scene.forEachObjectIn(frustum, [&](std::size_t i) {
+        if (frustum.classify(objects[i].getBounds()) !=
+            Frustum::Containment::Outside) {
+            visible.objects.push_back(i);
+        }
+    });
+    // keep the draw order stable, whatever order the tree happens to be in
+    std::sort(std::begin(visible.objects), std::end(visible.objects));
+
+    pointLightBounds.clear();
+    for (const auto& light : scene.getPointLights()) {
+        pointLightBounds.add(light.getBoundingSphere());
+    }
+    pointLightBounds.cull(frustum, visible.pointLights);
+
+    stats.objectsSubmitted = visible.objects.size();
+    stats.objectsCulled = objects.size() - visible.objects.size();
+    stats.pointLightsSubmitted = visible.pointLights.size();
+    stats.pointLightsCulled =
+          pointLightBounds.size() - visible.pointLights.size();
+}
+
+NS_KEPLER_END
@@ -0,0 +1,58 @@
+#ifndef CULLING_HPP
+#define CULLING_HPP
+
+#include "common/bounds.hpp"
+#include "common/types.hpp"
+#include "kepler_config.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+NS_KEPLER_BEGIN
+
+class Scene;
+
+// bounding spheres stored one component per array, so that testing a batch of
+// them against a plane is a straight loop that the compiler can vectorize
+class SphereBatch {
+   public:
+    void clear();
+    void add(const BoundingSphere& sphere);
+    std::size_t size() const { return radius.size(); }
+
+    // appends the indices of the spheres at least partly inside the frustum
+    void cull(const Frustum& frustum, std::vector<std::size_t>& visible);
+
+   private:
+    std::vector<float> x, y, z, radius;
+    std::vector<std::uint8_t> inside;
+};
+
+// indices into the scene's objects and point lights
+struct VisibleSet {
+    std::vector<std::size_t> objects;
+    std::vector<std::size_t> pointLights;
+};
+
+class SceneCuller {
+   public:
+    struct Stats {
+        std::size_t objectsSubmitted = 0;
+        std::size_t objectsCulled = 0;
+        std::size_t pointLightsSubmitted = 0;
+        std::size_t pointLightsCulled = 0;
+    };
+
+    void cull(const Scene& scene, const Frustum& frustum, VisibleSet& visible);
+
+    Stats getStats() const { return stats; }
+
+   private:
+    SphereBatch pointLightBounds;
+    Stats stats;
+};
+
+NS_KEPLER_END
+
+#endif
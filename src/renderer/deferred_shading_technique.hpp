@@ -9,6 +9,7 @@ NS_KEPLER_BEGIN
 
 struct GBuffer;
 class Scene;
+struct VisibleSet;
 struct Resolution;
 
 struct DeferredShadingTechnique {
@@ -17,6 +18,7 @@ struct DeferredShadingTechnique {
     virtual void doDeferredPass(GBuffer& gBuffer,
                                 FrameBuffer::View outputFrameBuffer,
                                 Scene& scene,
+                                const VisibleSet& visible,
                                 const glm::mat4& viewTransform,
                                 const glm::mat4& projectionTransform,
                                 const Resolution resolution) = 0;
@@ -0,0 +1,92 @@
+#include "renderer/frame_uniforms.hpp"
+#include "gl/shader.hpp"
+#include "renderer/culling.hpp"
+#include "scene/scene.hpp"
+
+#include <algorithm>
+#include <cstddef>
+
+NS_KEPLER_BEGIN
+
+namespace {
+using LightsBlock = FrameUniforms::LightsBlock;
+static_assert(offsetof(LightsBlock::PointLight, radius) == 60,
+              "radius should be packed in after position");
+static_assert(sizeof(LightsBlock::PointLight) == 64 &&
+                    sizeof(LightsBlock::DirectionalLight) == 64,
+              "struct array elements should be padded to a multiple of 16");
+static_assert(offsetof(LightsBlock, pointLightCount) ==
+                    64 * (FrameUniforms::MaxPointLights +
+                          FrameUniforms::MaxDirectionalLights),
+              "the counts should follow the light arrays");
+
+// binding a range has to start at a multiple of this
+std::size_t getOffsetAlignment() {
+    static const std::size_t alignment = [] {
+        GLint value = 0;
+        GL_CHECK(glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &value));
+        return static_cast<std::size_t>(std::max(value, 1));
+    }();
+    return alignment;
+}
+
+template <typename Block>
+void writeBlock(StreamBuffer& stream, const Block& block, GLuint binding) {
+    static_assert(std140::is_block<Block>::value,
+                  "uniform blocks must be laid out for std140");
+    const auto offset = stream.write(&block, sizeof(Block),
+                                     std::max(getOffsetAlignment(),
+                                              std140::vec4Alignment));
+    GL::state::bindBufferRange(GL_UNIFORM_BUFFER, binding, stream.getHandle(),
+                               offset, sizeof(Block));
+}
+}  // namespace
+
+constexpr std::size_t FrameUniforms::MaxPointLights;
+constexpr std::size_t FrameUniforms::MaxDirectionalLights;
+
+void FrameUniforms::update(const Scene& scene,
+                           const VisibleSet& visible,
+                           const glm::mat4& viewTransform,
+                           const glm::mat4& projectionTransform,
+                           StreamBuffer& stream) {
+    writeBlock(stream, CameraBlock{viewTransform, projectionTransform},
+               Binding::Camera);
+    writeBlock(stream, GBufferBlock{glm::inverse(projectionTransform)},
+               Binding::GBuffer);
+
+    const auto& pointLights = scene.getPointLights();
+    const auto pointLightCount =
+          std::min(visible.pointLights.size(), MaxPointLights);
+    for (std::size_t i = 0; i < pointLightCount; ++i) {
+        const auto& light = pointLights[visible.pointLights[i]];
+        lightsData.pointLights[i] = {
+              light.colors.ambient.rep(), light.colors.diffuse.rep(),
+              light.colors.specular.rep(), light.getViewPosition(viewTransform),
+              light.radius.rep()};
+    }
+    lightsData.pointLightCount = static_cast<GLint>(pointLightCount);
+
+    const auto& directionalLights = scene.getDirectionalLights();
+    const auto directionalLightCount =
+          std::min(directionalLights.size(), MaxDirectionalLights);
+    for (std::size_t i = 0; i < directionalLightCount; ++i) {
+        const auto& light = directionalLights[i];
+        lightsData.directionalLights[i] = {
+              light.colors.ambient.rep(), light.colors.diffuse.rep(),
+              light.colors.specular.rep(),
+              light.getViewDirection(viewTransform)};
+    }
+    lightsData.directionalLightCount =
+          static_cast<GLint>(directionalLightCount);
+
+    writeBlock(stream, lightsData, Binding::Lights);
+}
+
+void FrameUniforms::bindBlocks(Shader& shader) {
+    shader.bindUniformBlock("Camera", Binding::Camera);
+    shader.bindUniformBlock("Lights", Binding::Lights);
+    shader.bindUniformBlock("GBuffer", Binding::GBuffer);
+}
+
+NS_KEPLER_END
@@ -0,0 +1,84 @@
+#ifndef FRAME_UNIFORMS_HPP
+#define FRAME_UNIFORMS_HPP
+
+#include "common/types.hpp"
+#include "gl/buffer.hpp"
+#include "gl/stream_buffer.hpp"
+#include "kepler_config.hpp"
+#include "renderer/gbuffer.hpp"
+
+#include <cstddef>
+
+NS_KEPLER_BEGIN
+
+class Scene;
+class Shader;
+struct VisibleSet;
+
+// the uniform blocks every program shares, uploaded once per frame instead of
+// once per program (or per draw). each frame's blocks go into the stream
+// buffer, and the binding points are pointed at wherever they landed.
+class FrameUniforms {
+   public:
+    struct Binding {
+        enum {
+            Camera,
+            Lights,
+            GBuffer,
+        };
+        Binding() = delete;
+    };
+
+    // must match MAX_POINT_LIGHTS and MAX_DIRECTIONAL_LIGHTS in the shaders
+    static constexpr std::size_t MaxPointLights = 64;
+    static constexpr std::size_t MaxDirectionalLights = 8;
+
+    struct CameraBlock {
+        glm::mat4 view;
+        glm::mat4 projection;
+    };
+
+    struct LightsBlock {
+        struct PointLight {
+            alignas(std140::vec4Alignment) glm::vec3 ambient;
+            alignas(std140::vec4Alignment) glm::vec3 diffuse;
+            alignas(std140::vec4Alignment) glm::vec3 specular;
+            alignas(std140::vec4Alignment) glm::vec3 position;
+            float radius;
+        };
+        struct DirectionalLight {
+            alignas(std140::vec4Alignment) glm::vec3 ambient;
+            alignas(std140::vec4Alignment) glm::vec3 diffuse;
+            alignas(std140::vec4Alignment) glm::vec3 specular;
+            alignas(std140::vec4Alignment) glm::vec3 direction;
+        };
+        PointLight pointLights[MaxPointLights];
+        DirectionalLight directionalLights[MaxDirectionalLights];
+        GLint pointLightCount;
+        GLint directionalLightCount;
+    };
+
+    // what shaders/gbuffer.glsl needs to know
+    struct GBufferBlock {
+        glm::mat4 inverseProjection;
+    };
+
+    // only visible point lights go in the Lights block. lights past the
+    // maximums are left out.
+    void update(const Scene& scene,
+                const VisibleSet& visible,
+                const glm::mat4& viewTransform,
+                const glm::mat4& projectionTransform,
+                StreamBuffer& stream);
+
+    // points whichever of the blocks the program declares at their binding
+    // points
+    static void bindBlocks(Shader& shader);
+
+   private:
+    LightsBlock lightsData;
+};
+
+NS_KEPLER_END
+
+#endif
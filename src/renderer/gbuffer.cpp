@@ -1,7 +1,9 @@
 #include "renderer/gbuffer.hpp"
 
 #include <algorithm>
+#include <cassert>
 #include <numeric>
+#include <string>
 #include <vector>
 
 NS_KEPLER_BEGIN
@@ -18,17 +20,13 @@ std::vector<T> drop(const std::vector<T>& vec) {
     return ret;
 }
 
-auto getColorFormats() {
-    std::vector<Texture::Format> formats(GBuffer::Target::MAX);
-    formats[GBuffer::Target::PositionRGB_SpecularA] = {
-          GL_RGBA, GL_UNSIGNED_BYTE, GL_RGBA16F};
-    formats[GBuffer::Target::NormalRGB_RoughnessA] = {GL_RGBA, GL_UNSIGNED_BYTE,
-                                                      GL_RGBA16F};
-    formats[GBuffer::Target::Diffuse] = {GL_RGB, GL_UNSIGNED_BYTE};
-    return formats;
-}
-auto getAttachmentConfig() {
-    const auto formats = getColorFormats();
+// as FrameBuffer makes it
+const Texture::Format depthFormat{GL_DEPTH_COMPONENT, GL_FLOAT};
+
+auto getAttachmentConfig(const GBuffer::Formats& colorFormats) {
+    std::vector<Texture::Format> formats;
+    std::transform(std::begin(colorFormats), std::end(colorFormats),
+                   std::back_inserter(formats), Texture::Format::of);
     return FrameBuffer::Attachments::Options{
           formats[0],
           true,
@@ -36,10 +34,74 @@ auto getAttachmentConfig() {
           drop<1>(formats),
     };
 }
+
+const GBuffer::Formats& checkFormats(GBuffer::Layout layout,
+                                     const GBuffer::Formats& formats) {
+    for (std::size_t target = 0; target < formats.size(); ++target) {
+        if (!GBuffer::supportsFormat(layout, target, formats[target])) {
+            throw GBuffer::unsupported_format{
+                  "G-buffer target " + std::to_string(target) +
+                  " can't be stored as " + Texture::getName(formats[target])};
+        }
+    }
+    return formats;
+}
+
+// the samplers in shaders/gbuffer.glsl, by target
+const char* const samplerNames[] = {"gBuffer0", "gBuffer1", "gBuffer2",
+                                    "gBufferDepth"};
+static_assert(sizeof(samplerNames) / sizeof(*samplerNames) ==
+                    GBuffer::DepthTarget + 1,
+              "every target needs a sampler");
+
+// that shaderSources builds for
+GBuffer::Layout shaderLayout = GBuffer::Layout::Full;
 }  // namespace
 
-GBuffer::GBuffer(Resolution resolution)
-    : frameBuffer{resolution, getAttachmentConfig()} {}
+GBuffer::GBuffer(Resolution resolution, Layout in_layout)
+    : GBuffer{resolution, in_layout, getDefaultFormats(in_layout)} {}
+
+GBuffer::GBuffer(Resolution resolution,
+                 Layout in_layout,
+                 const Formats& in_formats)
+    : layout{in_layout}
+    , formats{checkFormats(layout, in_formats)}
+    , frameBuffer{resolution, getAttachmentConfig(formats)} {}
+
+auto GBuffer::getDefaultFormats(Layout layout) -> Formats {
+    using F = Texture::ColorFormat;
+    switch (layout) {
+        case Layout::Full:
+            return {{F::RGBA16F, F::RGBA16F, F::RGBA8}};
+        case Layout::Compact:
+            return {{F::RG16F, F::RGBA8, F::RGBA8}};
+    }
+    assert(false && "unknown layout");
+    return {};
+}
+
+bool GBuffer::supportsFormat(Layout layout,
+                             std::size_t target,
+                             Texture::ColorFormat format) {
+    assert(target < Target::MAX);
+    using F = Texture::ColorFormat;
+    if (layout == Layout::Full && target != Target::Diffuse) {
+        // signed, unbounded, and with something in alpha
+        return format == F::RGBA16F;
+    }
+    // the compact layout's first two targets only use two channels, in [0, 1]
+    return format != F::RG16F || target != Target::Diffuse;
+}
+
+std::size_t GBuffer::getBytesPerPixel(const Formats& formats) {
+    return std::accumulate(std::begin(formats), std::end(formats),
+                           depthFormat.getBytesPerPixel(),
+                           [](std::size_t sum, Texture::ColorFormat format) {
+                               return sum +
+                                      Texture::Format::of(format)
+                                            .getBytesPerPixel();
+                           });
+}
 
 auto GBuffer::getBuffers() const -> Buffers {
     Buffers buffers;
@@ -66,4 +128,38 @@ const Texture& GBuffer::getColorTarget(std::size_t target) const {
     return frameBuffer.attachments.additionalColors[target - 1];
 }
 
+void GBuffer::bindTextures(Shader& shader) {
+    for (int target = 0; target < Target::MAX; ++target) {
+        getColorTarget(target).bind(target);
+        GL_CHECK(shader.setUniform(samplerNames[target], target));
+    }
+    // only the compact layout needs the depth, but it costs nothing to bind
+    getDepthTarget().bind(DepthTarget);
+    GL_CHECK(shader.setUniform(samplerNames[DepthTarget],
+                               static_cast<int>(DepthTarget)));
+}
+
+ShaderSources GBuffer::shaderSources(const fs::AbsolutePath& vertexPath,
+                                     const fs::AbsolutePath& fragmentPath,
+                                     ShaderSources::Defines defines) {
+    defines["GBUFFER_LAYOUT"] = shaderLayout == Layout::Compact
+                                      ? "GBUFFER_LAYOUT_COMPACT"
+                                      : "GBUFFER_LAYOUT_FULL";
+    return ShaderSources{
+          {{Shader::Type::Vertex, {{fs::loadFileAsString(vertexPath)}}},
+           {Shader::Type::Fragment, {{fs::loadFileAsString(fragmentPath)}}}},
+          defines};
+}
+
+void GBuffer::setShaderLayout(Layout layout) {
+    if (layout != shaderLayout) {
+        shaderLayout = layout;
+        Shader::rebuildAll();
+    }
+}
+
+auto GBuffer::getShaderLayout() -> Layout {
+    return shaderLayout;
+}
+
 NS_KEPLER_END
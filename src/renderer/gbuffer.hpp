@@ -1,14 +1,30 @@
 #ifndef GBUFFER_HPP
 #define GBUFFER_HPP
 
+#include "data/fs.hpp"
 #include "gl/frame_buffer.hpp"
+#include "gl/shader.hpp"
 #include "kepler_config.hpp"
 
 #include <array>
+#include <cstddef>
+#include <stdexcept>
 
 NS_KEPLER_BEGIN
 
 struct GBuffer {
+    // the full layout keeps view space positions and normals in half floats.
+    // the compact one keeps no positions at all, since they can be rebuilt
+    // from the depth and the inverse projection, stores normals in two
+    // channels (octahedrally), and packs specular and roughness into one
+    // 8-bit target. either way, shaders go through shaders/gbuffer.glsl.
+    enum class Layout {
+        Full,
+        Compact,
+    };
+
+    // as laid out by Layout::Full. in the compact layout the first two targets
+    // hold the normal and the specular and roughness instead.
     struct Target {
         enum {
             PositionRGB_SpecularA,
@@ -23,7 +39,32 @@ struct GBuffer {
         DepthTarget = Target::MAX,
     };
 
-    GBuffer(Resolution resolution);
+    // one per color target
+    using Formats = std::array<Texture::ColorFormat, Target::MAX>;
+    // the most precise each target needs in the layout
+    static Formats getDefaultFormats(Layout layout);
+    // whether the target keeps what the layout puts in it when stored in the
+    // format. positions and normals in the full layout are signed and
+    // unbounded, so they need RGBA16F. anything else will do, but RG16F only
+    // fits the compact layout's two-channel targets.
+    static bool supportsFormat(Layout layout,
+                               std::size_t target,
+                               Texture::ColorFormat format);
+
+    struct unsupported_format : std::runtime_error {
+        using runtime_error::runtime_error;
+    };
+
+    GBuffer(Resolution resolution, Layout in_layout = Layout::Full);
+    // throws unsupported_format
+    GBuffer(Resolution resolution,
+            Layout in_layout,
+            const Formats& in_formats);
+
+    Layout getLayout() const { return layout; }
+    const Formats& getFormats() const { return formats; }
+    // over every target, depth included
+    static std::size_t getBytesPerPixel(const Formats& formats);
 
     using Buffers = std::array<GLenum, Target::MAX>;
     Buffers getBuffers() const;
@@ -35,6 +76,10 @@ struct GBuffer {
         return *frameBuffer.attachments.depth;
     }
 
+    // binds the targets to texture units 0 to DepthTarget, and points the
+    // shader's G-buffer samplers at them
+    void bindTextures(Shader& shader);
+
     void bind() { frameBuffer.bind(); }
     void unbind() { frameBuffer.unbind(); }
 
@@ -44,7 +89,21 @@ struct GBuffer {
         frameBuffer.blit(mask, destination, resolution);
     }
 
+    // for fragment shaders that include gbuffer.glsl, with GBUFFER_LAYOUT
+    // defined as the layout set by setShaderLayout, along with the other
+    // defines. the programs built from them must be reloadable, so that they
+    // can be built again for another layout.
+    static ShaderSources shaderSources(const fs::AbsolutePath& vertexPath,
+                                       const fs::AbsolutePath& fragmentPath,
+                                       ShaderSources::Defines defines = {});
+    // Full until it's set. setting another layout builds every reloadable
+    // program again (see Shader::rebuildAll).
+    static void setShaderLayout(Layout layout);
+    static Layout getShaderLayout();
+
    private:
+    Layout layout;
+    Formats formats;
     FrameBuffer frameBuffer;
 };
 
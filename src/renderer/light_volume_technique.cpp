@@ -4,10 +4,17 @@
 #include "data/cube.hpp"
 #include "gl/frame_buffer.hpp"
 #include "gl/gl.hpp"
+#include "gl/gpu_profiler.hpp"
+#include "gl/mesh_registry.hpp"
+#include "renderer/culling.hpp"
+#include "renderer/frame_uniforms.hpp"
 #include "renderer/gbuffer.hpp"
 #include "scene/light.hpp"
 #include "scene/scene.hpp"
 
+#include <cstddef>
+#include <string>
+
 NS_KEPLER_BEGIN
 
 namespace {
@@ -21,19 +28,37 @@ std::array<Vertex, 6> getFullScreenQuad() {
           {{-1.f, 1.f, 0.f}, {}, {0.f, 1.f}, {}},
     }};
 }
+
+// lightType is one of the LIGHT_TYPEs in shaders/lightVolume.frag
+ShaderSources lightVolumeSources(const char* vertexPath,
+                                 const char* lightType) {
+    return GBuffer::shaderSources(fs::RelativePath(vertexPath),
+                                  fs::RelativePath("shaders/lightVolume.frag"),
+                                  {{"LIGHT_TYPE", lightType}});
+}
+
+ShaderSources directionalLightSources() {
+    return lightVolumeSources("shaders/position.vert",
+                              "LIGHT_TYPE_DIRECTIONAL");
+}
 }  // namespace
 
 LightVolumeTechnique_base::LightVolumeTechnique_base(
-      Shader in_pointLightShader,
-      Shader in_pointLightStencilPassShader,
-      Shader in_directionalLightShader)
-    : pointLightShader{std::move(in_pointLightShader)}
-    , pointLightStencilPassShader{std::move(in_pointLightStencilPassShader)}
-    , pointLightVolume{std::make_shared<VertexBuffer>(getCubeVerts()),
+      Shader::Pending in_pointLightShader,
+      Shader::Pending in_pointLightStencilPassShader,
+      Shader::Pending in_directionalLightShader)
+    : pointLightShader{in_pointLightShader.take()}
+    , pointLightStencilPassShader{in_pointLightStencilPassShader.take()}
+    , pointLightVolume{MeshRegistry::getIndexed(getCubeVerts()),
                        pointLightShader}
-    , directionalLightShader{std::move(in_directionalLightShader)}
-    , directionalLightQuad{std::make_shared<VertexBuffer>(getFullScreenQuad()),
-                           directionalLightShader} {}
+    , directionalLightShader{in_directionalLightShader.take()}
+    , directionalLightQuad{MeshRegistry::get(getFullScreenQuad()),
+                           directionalLightShader}
+    , directionalLightUniforms{directionalLightShader, "light"} {
+    FrameUniforms::bindBlocks(pointLightShader);
+    FrameUniforms::bindBlocks(pointLightStencilPassShader);
+    FrameUniforms::bindBlocks(directionalLightShader);
+}
 
 bool LightVolumeTechnique_base::blitsGBufferDepth() const {
     return true;
@@ -43,6 +68,7 @@ void LightVolumeTechnique_base::doDeferredPass(
       GBuffer& gBuffer,
       FrameBuffer::View outputFrameBuffer,
       Scene& scene,
+      const VisibleSet& visible,
       const glm::mat4& viewTransform,
       const glm::mat4& projectionTransform,
       const Resolution resolution) {
@@ -51,8 +77,8 @@ void LightVolumeTechnique_base::doDeferredPass(
 
     glClearColor(0.f, 0.f, 0.f, 0.f);
     glClear(GL_COLOR_BUFFER_BIT);
-    drawPointLights(gBuffer, scene, viewTransform, projectionTransform,
-                    resolution);
+    drawPointLights(gBuffer, scene, visible, viewTransform,
+                    projectionTransform, resolution);
     drawDirectionalLights(gBuffer, scene, viewTransform, resolution);
 
     GL_CHECK();
@@ -61,21 +87,14 @@ void LightVolumeTechnique_base::doDeferredPass(
 void LightVolumeTechnique_base::setUniforms(GBuffer& gBuffer,
                                             Shader& shader,
                                             const Resolution resolution) {
-    auto bindColorTarget = [&](const auto& name, int target) {
-        gBuffer.getColorTarget(target).bind(target);
-        GL_CHECK(shader.setUniform(name, target));
-    };
-    bindColorTarget("positionRGB_specularA",
-                    GBuffer::Target::PositionRGB_SpecularA);
-    bindColorTarget("normalRGB_roughnessA",
-                    GBuffer::Target::NormalRGB_RoughnessA);
-    bindColorTarget("diffuse", GBuffer::Target::Diffuse);
+    gBuffer.bindTextures(shader);
     shader.setUniform("screenResolution", glm::vec2{resolution.rep()});
 }
 
 void LightVolumeTechnique_base::drawPointLights(
       GBuffer& gBuffer,
       Scene& scene,
+      const VisibleSet& visible,
       const glm::mat4& viewTransform,
       const glm::mat4& projectionTransform,
       const Resolution resolution) {
@@ -87,6 +106,7 @@ void LightVolumeTechnique_base::drawPointLights(
     GL::ScopedEnable<GL::StencilWrite> stencilWrite;
 
     {  // stencil pass
+        GPUProfiler::Scope profile{"stencil"};
         // a "perfect" stencil dealio here (which staunchly avoids calculating
         // any more pixels than necessary for each individual light) requires an
         // individual stencil pass for each light before rendering it, which is
@@ -100,26 +120,27 @@ void LightVolumeTechnique_base::drawPointLights(
         GL::ScopedDisable<GL::ColorWrite> noColorWrite;
         glClearStencil(128);
         glClear(GL_STENCIL_BUFFER_BIT);
-        glStencilFunc(GL_LESS, 0, 0xFF);
-        glStencilOpSeparate(GL_FRONT, GL_KEEP, GL_INCR, GL_ZERO);
-        glStencilOpSeparate(GL_BACK, GL_KEEP, GL_DECR, GL_KEEP);
+        GL::state::stencilFunc(GL_LESS, 0, 0xFF);
+        GL::state::stencilOpSeparate(GL_FRONT, GL_KEEP, GL_INCR, GL_ZERO);
+        GL::state::stencilOpSeparate(GL_BACK, GL_KEEP, GL_DECR, GL_KEEP);
 
         GL_CHECK();
         pointLightVolume.bind();
-        drawPointLightsImpl(gBuffer, scene, viewTransform, projectionTransform,
-                            resolution, true);
+        drawPointLightsImpl(gBuffer, scene, visible, viewTransform,
+                            projectionTransform, resolution, true);
     }
-    glCullFace(GL_FRONT);
+    GPUProfiler::Scope profile{"point lights"};
+    GL::state::cullFace(GL_FRONT);
     GL::ScopedEnable<GL::Blending> enableBlending;
-    glBlendFunc(GL_ONE, GL_ONE);
-    glStencilFunc(GL_GREATER, 128, 0xFF);
+    GL::state::blendFunc(GL_ONE, GL_ONE);
+    GL::state::stencilFunc(GL_GREATER, 128, 0xFF);
     GL::StencilWrite::disable();
-    glDepthFunc(GL_GEQUAL);
+    GL::state::depthFunc(GL_GEQUAL);
     setUniforms(gBuffer, pointLightShader, resolution);
-    drawPointLightsImpl(gBuffer, scene, viewTransform, projectionTransform,
-                        resolution, false);
-    glCullFace(GL_BACK);
-    glDepthFunc(GL_LEQUAL);
+    drawPointLightsImpl(gBuffer, scene, visible, viewTransform,
+                        projectionTransform, resolution, false);
+    GL::state::cullFace(GL_BACK);
+    GL::state::depthFunc(GL_LEQUAL);
 }
 
 void LightVolumeTechnique_base::drawDirectionalLights(
@@ -127,8 +148,9 @@ void LightVolumeTechnique_base::drawDirectionalLights(
       Scene& scene,
       const glm::mat4& viewTransform,
       const Resolution resolution) {
+    GPUProfiler::Scope profile{"directional lights"};
     GL::ScopedEnable<GL::Blending> enableBlending;
-    glBlendFunc(GL_ONE, GL_ONE);
+    GL::state::blendFunc(GL_ONE, GL_ONE);
     GL::ScopedDisable<GL::DepthTest> noDepthTest;
     setUniforms(gBuffer, directionalLightShader, resolution);
     for (auto& light : scene.getDirectionalLights()) {
@@ -139,47 +161,43 @@ void LightVolumeTechnique_base::drawDirectionalLights(
 void LightVolumeTechnique_base::drawDirectionalLight(
       const DirectionalLight& light,
       const glm::mat4& viewTransform) {
-    light.applyUniforms("light", directionalLightShader, viewTransform);
+    light.applyUniforms(directionalLightUniforms, directionalLightShader,
+                        viewTransform);
     directionalLightQuad.bind();
-    glDrawArrays(GL_TRIANGLES, 0,
-                 directionalLightQuad.getBuffer().getElementCount());
+    glDrawArrays(GL_TRIANGLES, 0, directionalLightQuad.getVertexCount());
 }
 
 ///////
 
 LightVolumeTechnique::LightVolumeTechnique()
     : LightVolumeTechnique_base{
-            Shader{ShaderSources::withVertAndFrag(
-                  {fs::loadFileAsString(fs::RelativePath("shaders/"
-                                                         "lightVolume_"
-                                                         "pointLight.vert"))},
-                  {fs::loadFileAsString(fs::RelativePath("shaders/"
-                                                         "lightVolume_"
-                                                         "pointLight.frag"))})},
-            Shader{ShaderSources{{{Shader::Type::Vertex,
-                                   {{fs::loadFileAsString(fs::RelativePath(
-                                         "shaders/"
-                                         "lightVolume_pointLight.vert"))}}},
-                                  ShaderSources::emptyFragmentShader()}}},
-            Shader{ShaderSources::withVertAndFrag(
-                  {fs::loadFileAsString(
-                        fs::RelativePath("shaders/position.vert"))},
-                  {fs::loadFileAsString(fs::RelativePath(
-                        "shaders/lightVolume_directionalLight.frag"))})}} {}
+            Shader::compileReloadable([] {
+                return lightVolumeSources("shaders/lightVolume_pointLight.vert",
+                                          "LIGHT_TYPE_POINT");
+            }),
+            Shader::compileReloadable([] {
+                return ShaderSources{
+                      {{Shader::Type::Vertex,
+                        {{fs::loadFileAsString(fs::RelativePath(
+                              "shaders/lightVolume_pointLight.vert"))}}},
+                       ShaderSources::emptyFragmentShader()}};
+            }),
+            Shader::compileReloadable(directionalLightSources)}
+    , pointLightUniforms{pointLightShader, "light"}
+    , modelUniform{pointLightShader.getUniform("model")} {}
 
 void LightVolumeTechnique::drawPointLightsImpl(
       GBuffer&,
       Scene& scene,
+      const VisibleSet& visible,
       const glm::mat4& viewTransform,
-      const glm::mat4& projectionTransform,
+      const glm::mat4&,
       const Resolution,
       const bool stencilPass) {
-    Shader& shader =
-          stencilPass ? pointLightStencilPassShader : pointLightShader;
-    shader.setUniform("view", viewTransform);
-    shader.setUniform("projection", projectionTransform);
-    for (auto& light : scene.getPointLights()) {
-        drawPointLight(light, viewTransform, pointLightShader, stencilPass);
+    auto pointLights = scene.getPointLights();
+    for (const auto i : visible.pointLights) {
+        drawPointLight(pointLights[i], viewTransform, pointLightShader,
+                       stencilPass);
     }
 }
 
@@ -188,67 +206,65 @@ void LightVolumeTechnique::drawPointLight(const PointLight& light,
                                           Shader& shader,
                                           bool stencilPass) {
     if (!stencilPass) {
-        GL_CHECK(light.applyUniforms("light", shader, viewTransform));
+        GL_CHECK(light.applyUniforms(pointLightUniforms, shader,
+                                     viewTransform));
     }
-    GL_CHECK(shader.setUniform("model", light.getVolumeModelMatrix()));
-    GL_CHECK(glDrawArrays(GL_TRIANGLES, 0,
-                          pointLightVolume.getBuffer().getElementCount()));
+    GL_CHECK(shader.setUniform(modelUniform, light.getVolumeModelMatrix()));
+    GL_CHECK(pointLightVolume.draw());
 }
 
 //////////
 
 LightVolumeInstancedTechnique::LightVolumeInstancedTechnique()
     : LightVolumeTechnique_base{
-            Shader{ShaderSources::withVertAndFrag(
-                  {fs::loadFileAsString(fs::RelativePath(
-                        "shaders/lightVolume_pointLightInstanced.vert"))},
-                  {fs::loadFileAsString(fs::RelativePath(
-                        "shaders/"
-                        "lightVolume_pointLightInstanced.frag"))})},
-            Shader{ShaderSources{
-                  {{Shader::Type::Vertex,
-                    {{fs::loadFileAsString(fs::RelativePath(
-                          "shaders/"
-                          "lightVolume_pointLightInstanced.vert"))}}},
-                   ShaderSources::emptyFragmentShader()}}},
-            Shader{ShaderSources::withVertAndFrag(
-                  {fs::loadFileAsString(
-                        fs::RelativePath("shaders/position.vert"))},
-                  {fs::loadFileAsString(fs::RelativePath(
-                        "shaders/lightVolume_directionalLight.frag"))})}} {}
+            Shader::compileReloadable([] {
+                return lightVolumeSources(
+                      "shaders/lightVolume_pointLightInstanced.vert",
+                      "LIGHT_TYPE_POINT_INSTANCED");
+            }),
+            Shader::compileReloadable([] {
+                return ShaderSources{
+                      {{Shader::Type::Vertex,
+                        {{fs::loadFileAsString(fs::RelativePath(
+                              "shaders/"
+                              "lightVolume_pointLightInstanced.vert"))}}},
+                       ShaderSources::emptyFragmentShader()}};
+            }),
+            Shader::compileReloadable(directionalLightSources)} {}
+
+void LightVolumeInstancedTechnique::addInstanceAttributes(
+      const std::shared_ptr<LightData::PointLightInstanceBuffer>& buffer) {
+    using Instance = LightData::PointLightInstance;
+    auto addAttribute = [&](const std::string& name, GLsizei size,
+                            std::size_t offset) {
+        pointLightVolume.addInstancedBuffer(name, pointLightShader, buffer,
+                                            size, sizeof(Instance), offset);
+    };
+    // the locations are explicit in the shader, so the stencil pass's program
+    // (which may have optimized some of these out) can share them
+    addAttribute("worldPos", 3, offsetof(Instance, position));
+    addAttribute("radius", 1, offsetof(Instance, radius));
+    addAttribute("ambientColor", 3, offsetof(Instance, ambientColor));
+    addAttribute("diffuseColor", 3, offsetof(Instance, diffuseColor));
+    addAttribute("specularColor", 3, offsetof(Instance, specularColor));
+}
 
 void LightVolumeInstancedTechnique::drawPointLightsImpl(
       GBuffer&,
       Scene& scene,
-      const glm::mat4& viewTransform,
-      const glm::mat4& projectionTransform,
+      const VisibleSet&,
+      const glm::mat4&,
+      const glm::mat4&,
       const Resolution,
       bool stencilPass) {
+    auto& lightData = scene.getLightData();
+    lightData.update();
+    addInstanceAttributes(lightData.getPointLightBuffer());
+
     Shader& shader =
           stencilPass ? pointLightStencilPassShader : pointLightShader;
     shader.bind();
-    shader.setUniform("view", viewTransform);
-    shader.setUniform("projection", projectionTransform);
-
-    pointLightVolume.addInstancedBuffer(
-          "worldPos", shader,
-          scene.getLightData().getPointLightPositionsBuffer());
-    pointLightVolume.addInstancedBuffer(
-          "radius", shader, scene.getLightData().getPointLightRadiiBuffer());
-    pointLightVolume.addInstancedBuffer(
-          "ambientColor", shader,
-          scene.getLightData().getPointLightAmbientColorBuffer());
-    pointLightVolume.addInstancedBuffer(
-          "diffuseColor", shader,
-          scene.getLightData().getPointLightDiffuseColorBuffer());
-    pointLightVolume.addInstancedBuffer(
-          "specularColor", shader,
-          scene.getLightData().getPointLightSpecularColorBuffer());
-
-    pointLightVolume.bind();
-    GL_CHECK(glDrawArraysInstanced(
-          GL_TRIANGLES, 0, pointLightVolume.getBuffer().getElementCount(),
-          scene.getPointLights().size()));
+    GL_CHECK(pointLightVolume.drawInstanced(scene.getPointLights().size()));
 }
 
 NS_KEPLER_END
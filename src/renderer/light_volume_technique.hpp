@@ -4,16 +4,18 @@
 #include "gl/shader.hpp"
 #include "gl/vertex_array.hpp"
 #include "renderer/deferred_shading_technique.hpp"
+#include "scene/light.hpp"
+#include "scene/light_data.hpp"
 
-NS_KEPLER_BEGIN
+#include <memory>
 
-struct DirectionalLight;
-struct PointLight;
+NS_KEPLER_BEGIN
 
 struct LightVolumeTechnique_base : public DeferredShadingTechnique {
     void doDeferredPass(GBuffer& gBuffer,
                         FrameBuffer::View outputFrameBuffer,
                         Scene& scene,
+                        const VisibleSet& visible,
                         const glm::mat4& viewTransform,
                         const glm::mat4& projectionTransform,
                         const Resolution resolution) override;
@@ -21,9 +23,10 @@ struct LightVolumeTechnique_base : public DeferredShadingTechnique {
     bool blitsGBufferDepth() const override;
 
    protected:
-    LightVolumeTechnique_base(Shader pointLightShader,
-                              Shader pointLightStencilPassShader,
-                              Shader directionalLightShader);
+    // the three are submitted together, before any is waited on
+    LightVolumeTechnique_base(Shader::Pending pointLightShader,
+                              Shader::Pending pointLightStencilPassShader,
+                              Shader::Pending directionalLightShader);
 
     void setUniforms(GBuffer& gBuffer,
                      Shader& shader,
@@ -31,6 +34,7 @@ struct LightVolumeTechnique_base : public DeferredShadingTechnique {
 
     void drawPointLights(GBuffer& gBuffer,
                          Scene& scene,
+                         const VisibleSet& visible,
                          const glm::mat4& viewTransform,
                          const glm::mat4& projectionTransform,
                          const Resolution resolution);
@@ -38,6 +42,7 @@ struct LightVolumeTechnique_base : public DeferredShadingTechnique {
    protected:
     virtual void drawPointLightsImpl(GBuffer& gBuffer,
                                      Scene& scene,
+                                     const VisibleSet& visible,
                                      const glm::mat4& viewTransform,
                                      const glm::mat4& projectionTransform,
                                      const Resolution resolution,
@@ -57,6 +62,7 @@ struct LightVolumeTechnique_base : public DeferredShadingTechnique {
 
     Shader directionalLightShader;
     VertexArrayObject directionalLightQuad;
+    DirectionalLight::Uniforms directionalLightUniforms;
 };
 
 struct LightVolumeTechnique final : public LightVolumeTechnique_base {
@@ -65,6 +71,7 @@ struct LightVolumeTechnique final : public LightVolumeTechnique_base {
    private:
     void drawPointLightsImpl(GBuffer& gBuffer,
                              Scene& scene,
+                             const VisibleSet& visible,
                              const glm::mat4& viewTransform,
                              const glm::mat4& projectionTransform,
                              const Resolution resolution,
@@ -74,6 +81,9 @@ struct LightVolumeTechnique final : public LightVolumeTechnique_base {
                         const glm::mat4& viewTransform,
                         Shader& shader,
                         bool stencilPass);
+
+    PointLight::Uniforms pointLightUniforms;
+    Shader::Uniform modelUniform;
 };
 
 struct LightVolumeInstancedTechnique final : public LightVolumeTechnique_base {
@@ -82,10 +92,14 @@ struct LightVolumeInstancedTechnique final : public LightVolumeTechnique_base {
    private:
     void drawPointLightsImpl(GBuffer& gBuffer,
                              Scene& scene,
+                             const VisibleSet& visible,
                              const glm::mat4& viewTransform,
                              const glm::mat4& projectionTransform,
                              const Resolution resolution,
                              bool stencilPass) override;
+
+    void addInstanceAttributes(
+          const std::shared_ptr<LightData::PointLightInstanceBuffer>& buffer);
 };
 
 NS_KEPLER_END
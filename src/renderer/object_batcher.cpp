@@ -0,0 +1,229 @@
+#include "renderer/object_batcher.hpp"
+#include "data/fs.hpp"
+#include "renderer/frame_uniforms.hpp"
+#include "renderer/gbuffer.hpp"
+#include "scene/scene.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+NS_KEPLER_BEGIN
+
+namespace {
+std::shared_ptr<Shader> instancedPhongShader() {
+    static const fs::AbsolutePath vertPath =
+          fs::RelativePath{"shaders/phong_instanced.vert"};
+    static const fs::AbsolutePath fragPath =
+          fs::RelativePath{"shaders/phong.frag"};
+    auto shader = Shader::createReloadable(
+          [] { return GBuffer::shaderSources(vertPath, fragPath); });
+    FrameUniforms::bindBlocks(*shader);
+    GL_CHECK();
+    return shader;
+}
+}  // namespace
+
+ObjectBatcher::Mesh::Mesh(const VertexArrayObject& source, Shader& shader)
+    : vao{source, shader}, used{true} {}
+
+ObjectBatcher::ObjectBatcher()
+    : shader{instancedPhongShader()}, materialUniforms{*shader, "material"} {}
+
+MeshArena& ObjectBatcher::getArena(const VertexLayoutDescription& layout) {
+    auto it = arenas.find(layout.attributes);
+    if (it == std::end(arenas)) {
+        it = arenas.emplace(std::piecewise_construct,
+                            std::forward_as_tuple(layout.attributes),
+                            std::forward_as_tuple(layout, *shader))
+                   .first;
+    }
+    return it->second;
+}
+
+auto ObjectBatcher::getMesh(const VertexArrayObject& source) -> Mesh& {
+    const auto key = &source.getBuffer();
+    auto it = meshes.find(key);
+    if (it == std::end(meshes)) {
+        it = meshes.emplace(std::piecewise_construct,
+                            std::forward_as_tuple(key),
+                            std::forward_as_tuple(source, *shader))
+                   .first;
+    }
+    it->second.used = true;
+    return it->second;
+}
+
+void ObjectBatcher::draw(Scene& scene,
+                         const std::vector<std::size_t>& order,
+                         const glm::mat4& view,
+                         const glm::mat4& projection,
+                         const std::shared_ptr<StreamBuffer>& stream) {
+    stats = {};
+    auto objects = scene.getObjects();
+
+    batchIndices.clear();
+    batches.clear();
+    for (const auto i : order) {
+        const auto& material = objects[i].getMaterial();
+        const BatchKey key{&objects[i].getVertexArray().getBuffer(),
+                           material.diffuse->getHandle(),
+                           material.specular->getHandle(),
+                           material.shininess};
+        const auto inserted = batchIndices.emplace(key, batches.size());
+        if (inserted.second) {
+            batches.emplace_back();
+        }
+        batches[inserted.first->second].objects.push_back(i);
+    }
+
+    for (auto& mesh : meshes) {
+        mesh.second.used = false;
+    }
+    if (GL::extensions::hasMultiDrawIndirect()) {
+        drawIndirect(scene, view, stream);
+    }
+    for (const auto& batch : batches) {
+        if (batch.objects.size() == 1) {
+            auto& object = objects[batch.objects.front()];
+            GL_CHECK(object.setUniforms(view, projection));
+            GL_CHECK(object.render());
+        } else {
+            drawBatch(scene, batch, view, stream);
+            stats.instancedObjects += batch.objects.size();
+        }
+        ++stats.drawCalls;
+    }
+    // the cache keeps its meshes alive, so drop the ones nothing draws anymore
+    for (auto it = std::begin(meshes); it != std::end(meshes);) {
+        if (!it->second.used &&
+            it->second.vao.getSharedBuffer().use_count() == 1) {
+            it = meshes.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void ObjectBatcher::drawBatch(Scene& scene,
+                              const Batch& batch,
+                              const glm::mat4& view,
+                              const std::shared_ptr<StreamBuffer>& stream) {
+    auto objects = scene.getObjects();
+    instances.clear();
+    for (const auto i : batch.objects) {
+        const auto modelView = view * objects[i].getModelMatrix();
+        instances.push_back({modelView, matrix::normal(modelView)});
+    }
+
+    const auto& first = objects[batch.objects.front()];
+    auto& mesh = getMesh(first.getVertexArray());
+    const auto offset = stream->write(instances);
+    mesh.vao.addInstancedMatrix("modelView", *shader, stream, 4, 4,
+                                sizeof(Instance),
+                                offset + offsetof(Instance, modelView));
+    mesh.vao.addInstancedMatrix("normalMatrix", *shader, stream, 3, 3,
+                                sizeof(Instance),
+                                offset + offsetof(Instance, normalMatrix));
+
+    shader->bind();
+    first.getMaterial().applyUniforms(materialUniforms, *shader);
+    GL_CHECK(mesh.vao.drawInstanced(instances.size()));
+}
+
+void ObjectBatcher::drawIndirect(Scene& scene,
+                                 const glm::mat4& view,
+                                 const std::shared_ptr<StreamBuffer>& stream) {
+    auto objects = scene.getObjects();
+    for (auto& arena : arenas) {
+        arena.second.collect();
+    }
+
+    runIndices.clear();
+    runs.clear();
+    for (std::size_t b = 0; b < batches.size(); ++b) {
+        const auto& first = objects[batches[b].objects.front()];
+        const auto& vao = first.getVertexArray();
+        if (!vao.getIndexBuffer()) {
+            continue;
+        }
+        const auto& material = first.getMaterial();
+        const RunKey key{vao.getLayout().attributes,
+                         material.diffuse->getHandle(),
+                         material.specular->getHandle(), material.shininess};
+        const auto inserted = runIndices.emplace(key, runs.size());
+        if (inserted.second) {
+            runs.push_back({&getArena(vao.getLayout()), {}, 0});
+        }
+        runs[inserted.first->second].batches.push_back(b);
+    }
+    if (runs.empty()) {
+        return;
+    }
+
+    // every run's instances and commands go in one write each. each command's
+    // base instance is where its batch's instances start.
+    instances.clear();
+    commands.clear();
+    for (auto& run : runs) {
+        run.firstCommand = commands.size();
+        for (const auto b : run.batches) {
+            const auto& batch = batches[b];
+            const auto range = run.arena->add(
+                  objects[batch.objects.front()].getVertexArray());
+            commands.push_back({range.indexCount,
+                                static_cast<GLuint>(batch.objects.size()),
+                                range.firstIndex, range.baseVertex,
+                                static_cast<GLuint>(instances.size())});
+            for (const auto i : batch.objects) {
+                const auto modelView = view * objects[i].getModelMatrix();
+                instances.push_back({modelView, matrix::normal(modelView)});
+            }
+        }
+    }
+    const auto instanceOffset = stream->write(instances);
+    const auto commandOffset = stream->write(commands);
+    GL::state::bindBuffer(GL_DRAW_INDIRECT_BUFFER, stream->getHandle());
+
+    shader->bind();
+    for (std::size_t r = 0; r < runs.size(); ++r) {
+        const auto& run = runs[r];
+        // the arenas are done growing, so their vertex arrays are final
+        auto& vao = run.arena->getVertexArray();
+        vao.addInstancedMatrix("modelView", *shader, stream, 4, 4,
+                               sizeof(Instance),
+                               instanceOffset + offsetof(Instance, modelView));
+        vao.addInstancedMatrix(
+              "normalMatrix", *shader, stream, 3, 3, sizeof(Instance),
+              instanceOffset + offsetof(Instance, normalMatrix));
+        const auto& batch = batches[run.batches.front()];
+        objects[batch.objects.front()].getMaterial().applyUniforms(
+              materialUniforms, *shader);
+        vao.bind();
+
+        const auto commandCount = (r + 1 < runs.size()
+                                         ? runs[r + 1].firstCommand
+                                         : commands.size()) -
+                                  run.firstCommand;
+        GL_CHECK(GL::extensions::multiDrawElementsIndirect(
+              GL_TRIANGLES, GL_UNSIGNED_INT,
+              commandOffset + run.firstCommand * sizeof(commands[0]),
+              static_cast<GLsizei>(commandCount)));
+        ++stats.drawCalls;
+        stats.indirectDraws += commandCount;
+        for (const auto b : run.batches) {
+            stats.instancedObjects += batches[b].objects.size();
+        }
+    }
+
+    // leave the rest to be drawn as usual
+    batches.erase(std::remove_if(std::begin(batches), std::end(batches),
+                                 [&](const Batch& batch) {
+                                     return objects[batch.objects.front()]
+                                           .getVertexArray()
+                                           .getIndexBuffer() != nullptr;
+                                 }),
+                  std::end(batches));
+}
+
+NS_KEPLER_END
@@ -0,0 +1,106 @@
+#ifndef OBJECT_BATCHER_HPP
+#define OBJECT_BATCHER_HPP
+
+#include "common/types.hpp"
+#include "gl/buffer.hpp"
+#include "gl/extensions.hpp"
+#include "gl/mesh_arena.hpp"
+#include "gl/shader.hpp"
+#include "gl/stream_buffer.hpp"
+#include "gl/vertex_array.hpp"
+#include "kepler_config.hpp"
+#include "scene/material.hpp"
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+NS_KEPLER_BEGIN
+
+class Scene;
+
+// draws objects for the geometry pass, collapsing objects that share a mesh
+// and a material into a single instanced draw call. each object's matrices go
+// into the frame's stream buffer as instance attributes instead of uniforms.
+// where multi-draw indirect is available, batches that share a material are
+// drawn together too, even with different meshes (see MeshArena).
+class ObjectBatcher {
+   public:
+    struct Stats {
+        std::size_t drawCalls = 0;
+        std::size_t instancedObjects = 0;
+        // draws that went through multi-draw indirect commands rather than
+        // draw calls of their own
+        std::size_t indirectDraws = 0;
+    };
+
+    ObjectBatcher();
+
+    // objects are given by their index in the scene's objects, in the order
+    // they should be drawn. objects in the same batch are drawn together,
+    // where the first of them would have been.
+    void draw(Scene& scene,
+              const std::vector<std::size_t>& order,
+              const glm::mat4& view,
+              const glm::mat4& projection,
+              const std::shared_ptr<StreamBuffer>& stream);
+
+    Stats getStats() const { return stats; }
+
+   private:
+    struct Instance {
+        glm::mat4 modelView;
+        glm::mat3 normalMatrix;
+    };
+
+    // a copy of an object's vertex array, set up for the instanced shader
+    struct Mesh {
+        Mesh(const VertexArrayObject& source, Shader& shader);
+        VertexArrayObject vao;
+        bool used;
+    };
+    Mesh& getMesh(const VertexArrayObject& source);
+
+    using BatchKey =
+          std::tuple<const VertexAttributeBuffer_base*, GLuint, GLuint, float>;
+    struct Batch {
+        std::vector<std::size_t> objects;
+    };
+    void drawBatch(Scene& scene,
+                   const Batch& batch,
+                   const glm::mat4& view,
+                   const std::shared_ptr<StreamBuffer>& stream);
+
+    // each batch becomes one command, and batches with the same material and
+    // vertex layout are drawn by one multi-draw. non-indexed meshes can't go
+    // in an arena, so their batches are left in place to be drawn as usual.
+    void drawIndirect(Scene& scene,
+                      const glm::mat4& view,
+                      const std::shared_ptr<StreamBuffer>& stream);
+    MeshArena& getArena(const VertexLayoutDescription& layout);
+
+    using RunKey = std::tuple<const VertexAttribute*, GLuint, GLuint, float>;
+    struct Run {
+        MeshArena* arena;
+        std::vector<std::size_t> batches;
+        std::size_t firstCommand;
+    };
+
+    std::shared_ptr<Shader> shader;
+    Material::Uniforms materialUniforms;
+    std::map<const VertexAttributeBuffer_base*, Mesh> meshes;
+    std::map<BatchKey, std::size_t> batchIndices;
+    std::vector<Batch> batches;
+    std::map<const VertexAttribute*, MeshArena> arenas;
+    std::map<RunKey, std::size_t> runIndices;
+    std::vector<Run> runs;
+    std::vector<Instance> instances;
+    std::vector<GL::extensions::DrawElementsIndirectCommand> commands;
+    Stats stats;
+};
+
+NS_KEPLER_END
+
+#endif
@@ -2,6 +2,8 @@
 #include "data/fs.hpp"
 #include "data/quad.hpp"
 #include "gl/frame_buffer.hpp"
+#include "gl/gpu_profiler.hpp"
+#include "gl/mesh_registry.hpp"
 #include "gl/vertex_array.hpp"
 
 #include <cassert>
@@ -20,7 +22,7 @@ std::shared_ptr<VertexArrayObject> makeFullscreenVAO() {
                           {fs::loadFileAsString(fs::RelativePath{
                                 "shaders/position_texcoord.vert"})}}}});
     return std::make_shared<VertexArrayObject>(
-          std::make_shared<VertexBuffer>(getFullScreenQuadVerts()), *shader);
+          MeshRegistry::get(getFullScreenQuadVerts()), *shader);
 }
 }  // namespace
 
@@ -32,10 +34,10 @@ std::shared_ptr<VertexArrayObject> PostprocessingStep::fullScreenVAO() {
     return vao;
 }
 std::unique_ptr<FrameBuffer> PostprocessingStep::createFBO(
-      Resolution resolution) {
+      Resolution resolution,
+      Texture::Format format) {
     return std::make_unique<FrameBuffer>(
-          resolution,
-          FrameBuffer::Attachments::Options{{GL_RGB, GL_FLOAT}, false, false});
+          resolution, FrameBuffer::Attachments::Options{format, false, false});
 }
 
 GroupedPostprocessingStep::GroupedPostprocessingStep(Steps in_steps)
@@ -53,7 +55,7 @@ void GroupedPostprocessingStep::append(Steps in_steps) {
 void GroupedPostprocessingStep::execute(const GBuffer& gBuffer,
                                         Texture& input,
                                         FrameBuffer::View output) {
-    setUpPool(input.getResolution());
+    setUpPool(input);
     std::shared_ptr<Texture> nextInput =
           std::shared_ptr<Texture>{&input, util::NoOp{}};
     for (auto it = std::begin(this->steps); it != std::end(this->steps); ++it) {
@@ -62,6 +64,7 @@ void GroupedPostprocessingStep::execute(const GBuffer& gBuffer,
         const auto nextOutputView = nextOutputFBO ? *nextOutputFBO : output;
 
         auto& step = *it;
+        GPUProfiler::Scope profile{step->getName()};
         step->execute(gBuffer, *nextInput, nextOutputView);
 
         if (!mainOutput) {
@@ -72,12 +75,16 @@ void GroupedPostprocessingStep::execute(const GBuffer& gBuffer,
     }
 }
 
-void GroupedPostprocessingStep::setUpPool(Resolution resolution) {
-    if (!fboPool || resolution.rep() != fboPool->resolution.rep()) {
-        fboPool = FBOPool{util::Pool<FrameBuffer>{[resolution] {
-                              return PostprocessingStep::createFBO(resolution);
+void GroupedPostprocessingStep::setUpPool(const Texture& input) {
+    const auto resolution = input.getResolution();
+    const auto format = input.getFormat();
+    if (!fboPool || resolution.rep() != fboPool->resolution.rep() ||
+        format != fboPool->format) {
+        fboPool = FBOPool{util::Pool<FrameBuffer>{[resolution, format] {
+                              return PostprocessingStep::createFBO(resolution,
+                                                                   format);
                           }},
-                          resolution};
+                          resolution, format};
     }
 }
 
@@ -3,6 +3,7 @@
 
 #include "gl/frame_buffer.hpp"
 #include "gl/shader.hpp"
+#include "gl/texture.hpp"
 #include "kepler_config.hpp"
 #include "util/optional.hpp"
 #include "util/pool.hpp"
@@ -14,7 +15,6 @@
 NS_KEPLER_BEGIN
 
 struct GBuffer;
-class Texture;
 struct VertexArrayObject;
 
 struct PostprocessingStep {
@@ -23,10 +23,13 @@ struct PostprocessingStep {
     virtual void execute(const GBuffer& gBuffer,
                          Texture& input,
                          FrameBuffer::View output) = 0;
+    // as the GPU profiler shows it
+    virtual std::string getName() const = 0;
 
     static std::shared_ptr<VertexArrayObject> fullScreenVAO();
 
-    static std::unique_ptr<FrameBuffer> createFBO(Resolution resolution);
+    static std::unique_ptr<FrameBuffer> createFBO(Resolution resolution,
+                                                  Texture::Format format);
 };
 
 struct GroupedPostprocessingStep : PostprocessingStep {
@@ -40,16 +43,19 @@ struct GroupedPostprocessingStep : PostprocessingStep {
     void execute(const GBuffer& gBuffer,
                  Texture& input,
                  FrameBuffer::View output) override;
+    std::string getName() const override { return "group"; }
 
    private:
     Steps steps;
     struct FBOPool {
         util::Pool<FrameBuffer> pool;
         Resolution resolution;
+        Texture::Format format;
     };
     util::optional<FBOPool> fboPool;
 
-    void setUpPool(Resolution resolution);
+    // the steps' intermediate targets match the input
+    void setUpPool(const Texture& input);
 };
 
 using PostprocessingPipeline = std::unique_ptr<PostprocessingStep>;
@@ -4,22 +4,24 @@
 #include "gl/shader.hpp"
 #include "kepler_config.hpp"
 #include "renderer/postprocessing/postprocessing_step.hpp"
+#include "util/optional.hpp"
 
 #include <string>
+#include <utility>
 #include <vector>
 
 NS_KEPLER_BEGIN
 
 struct SimplePostprocessingStep : PostprocessingStep {
+    // shaders/postprocessing/<name>.frag, which defines
+    //   vec4 <name>(vec4 currentFragment, sampler2D screen)
     struct StepDescriptor {
-        StepDescriptor(std::string in_name);
+        StepDescriptor(std::string in_name) : name{std::move(in_name)} {}
 
         const std::string& getName() const { return name; }
-        const ShaderSources::SourceUnit& getSource() const { return source; }
 
        private:
         std::string name;
-        ShaderSources::SourceUnit source;
     };
 
     SimplePostprocessingStep(const std::vector<StepDescriptor>& steps);
@@ -27,9 +29,16 @@ struct SimplePostprocessingStep : PostprocessingStep {
     void execute(const GBuffer& gBuffer,
                  Texture& input,
                  FrameBuffer::View output) override;
+    // the steps' names, joined with '+'
+    std::string getName() const override { return name; }
 
    private:
-    Shader shader;
+    std::string name;
+    // submitted on construction but taken on the first execute, so that it
+    // builds alongside whatever else is set up before the first frame
+    Shader::Pending pendingShader;
+    util::optional<Shader> shader;
+    Shader& getShader();
     std::shared_ptr<VertexArrayObject> vao;
 };
 
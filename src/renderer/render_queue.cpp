@@ -0,0 +1,106 @@
+#include "renderer/render_queue.hpp"
+#include "scene/scene.hpp"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <utility>
+
+NS_KEPLER_BEGIN
+
+namespace {
+struct Field {
+    unsigned shift, bits;
+
+    RenderQueue::Key pack(RenderQueue::Key value) const {
+        const auto mask = (RenderQueue::Key{1} << bits) - 1;
+        return (value & mask) << shift;
+    }
+};
+constexpr Field ProgramField{56, 8};
+constexpr Field MaterialField{40, 16};
+constexpr Field VertexArrayField{28, 12};
+constexpr Field DepthField{0, 28};
+
+constexpr unsigned RadixBits = 8;
+constexpr std::size_t RadixBuckets = std::size_t{1} << RadixBits;
+constexpr unsigned RadixPasses = 64 / RadixBits;
+}  // namespace
+
+void RenderQueue::build(const Scene& scene,
+                        const std::vector<std::size_t>& visible,
+                        const glm::mat4& view) {
+    const auto& objects = scene.getObjects();
+
+    // distance along the view direction, which is enough for ordering
+    depths.clear();
+    float nearest = std::numeric_limits<float>::max();
+    float farthest = 0.f;
+    for (const auto i : visible) {
+        const auto center = objects[i].getBoundingSphere().center;
+        const auto depth = std::max(-(view * glm::vec4{center, 1.f}).z, 0.f);
+        nearest = std::min(nearest, depth);
+        farthest = std::max(farthest, depth);
+        depths.push_back(depth);
+    }
+    const auto maxDepthKey = (Key{1} << DepthField.bits) - 1;
+    const auto depthScale =
+          farthest > nearest ? maxDepthKey / (farthest - nearest) : 0.f;
+
+    entries.clear();
+    for (std::size_t n = 0; n < visible.size(); ++n) {
+        const auto& object = objects[visible[n]];
+        const auto& material = object.getMaterial();
+        const auto depthKey =
+              static_cast<Key>((depths[n] - nearest) * depthScale);
+        const Key key =
+              ProgramField.pack(
+                    programIds.get(object.getShader().getHandle())) |
+              MaterialField.pack(materialIds.get(
+                    {material.diffuse->getHandle(),
+                     material.specular->getHandle()})) |
+              VertexArrayField.pack(
+                    vertexArrayIds.get(object.getVertexArray().getHandle())) |
+              DepthField.pack(std::min(depthKey, maxDepthKey));
+        entries.push_back({key, visible[n]});
+    }
+
+    sort();
+
+    order.clear();
+    for (const auto& entry : entries) {
+        order.push_back(entry.object);
+    }
+}
+
+// least significant digit first, so each pass keeps the order of the last
+void RenderQueue::sort() {
+    scratch.resize(entries.size());
+    for (unsigned pass = 0; pass < RadixPasses; ++pass) {
+        const auto shift = pass * RadixBits;
+        const auto digit = [shift](const Entry& entry) {
+            return (entry.key >> shift) & (RadixBuckets - 1);
+        };
+
+        std::array<std::size_t, RadixBuckets> offsets{};
+        for (const auto& entry : entries) {
+            ++offsets[digit(entry)];
+        }
+        // every key has the same digit here, so this pass wouldn't move
+        // anything. most passes end up like this for a typical scene.
+        if (entries.empty() || offsets[digit(entries.front())] ==
+                                     entries.size()) {
+            continue;
+        }
+        std::size_t total = 0;
+        for (auto& offset : offsets) {
+            total += std::exchange(offset, total);
+        }
+        for (const auto& entry : entries) {
+            scratch[offsets[digit(entry)]++] = entry;
+        }
+        std::swap(entries, scratch);
+    }
+}
+
+NS_KEPLER_END
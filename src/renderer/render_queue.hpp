@@ -0,0 +1,69 @@
+#ifndef RENDER_QUEUE_HPP
+#define RENDER_QUEUE_HPP
+
+#include "common/types.hpp"
+#include "gl/gl.hpp"
+#include "kepler_config.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+NS_KEPLER_BEGIN
+
+class Scene;
+
+// orders a frame's objects so that the geometry pass changes as little state
+// as possible between draws, and draws near things before far things so that
+// the depth test can throw away hidden fragments early. each object gets a
+// 64 bit key, from most to least significant:
+//     program (8 bits) | material (16 bits) | vertex array (12 bits) |
+//     depth (28 bits)
+// so sorting the keys groups draws by program, then by material, and so on.
+class RenderQueue {
+   public:
+    using Key = std::uint64_t;
+
+    // objects are given by their index in the scene's objects
+    void build(const Scene& scene,
+               const std::vector<std::size_t>& visible,
+               const glm::mat4& view);
+
+    // the indices passed to build, in drawing order
+    const std::vector<std::size_t>& getOrder() const { return order; }
+
+   private:
+    struct Entry {
+        Key key;
+        std::size_t object;
+    };
+    void sort();
+
+    // GL names aren't dense enough to fit in the key, so they're mapped to
+    // small ids the first time they're seen. running out of ids only makes the
+    // sort less effective; it's never wrong.
+    template <typename Name>
+    class IdMap {
+       public:
+        Key get(const Name& name) {
+            const auto it = ids.emplace(name, ids.size()).first;
+            return it->second;
+        }
+
+       private:
+        std::map<Name, Key> ids;
+    };
+    IdMap<GLuint> programIds;
+    IdMap<std::pair<GLuint, GLuint>> materialIds;
+    IdMap<GLuint> vertexArrayIds;
+
+    std::vector<Entry> entries, scratch;
+    std::vector<float> depths;
+    std::vector<std::size_t> order;
+};
+
+NS_KEPLER_END
+
+#endif
@@ -5,12 +5,16 @@
 #include "gl/binding.hpp"
 #include "gl/frame_buffer.hpp"
 #include "gl/gl.hpp"
+#include "gl/gpu_profiler.hpp"
+#include "renderer/clustered_technique.hpp"
 #include "renderer/light_volume_technique.hpp"
 #include "renderer/simple_technique.hpp"
 #include "scene/scene.hpp"
+#include "util/trace.hpp"
 
 #include <array>
 #include <iostream>
+#include <stdexcept>
 #include <string>
 
 NS_KEPLER_BEGIN
@@ -23,14 +27,44 @@ void setDrawBuffers(GBuffer& gBuffer) {
     GL_CHECK(glDrawBuffers(buffers.size(), buffers.data()));
 }
 
+// with the programs built for its layout
+GBuffer createGBuffer(Resolution resolution,
+                      const Renderer::TargetFormats& formats) {
+    GBuffer gBuffer{resolution, formats.gBufferLayout, formats.gBuffer};
+    GBuffer::setShaderLayout(formats.gBufferLayout);
+    return gBuffer;
+}
+
+// a few frames' worth of uniform blocks and instance attributes
+constexpr std::size_t streamBufferCapacity = 4 * 1024 * 1024;
+
 FrameBuffer::View screenOutputFramebuffer() {
     return FrameBuffer::View{0};
 }
+
+Texture::ColorFormat checkPostprocessingFormat(Texture::ColorFormat format) {
+    if (format == Texture::ColorFormat::RG16F) {
+        throw std::invalid_argument{
+              "postprocessing targets need at least three channels"};
+    }
+    return format;
+}
 }  // namespace
 
+auto Renderer::TargetFormats::defaults(GBuffer::Layout layout)
+      -> TargetFormats {
+    return {layout, GBuffer::getDefaultFormats(layout),
+            Texture::ColorFormat::RGBA8};
+}
+
+std::size_t Renderer::TargetFormats::getBytesPerPixel() const {
+    return GBuffer::getBytesPerPixel(gBuffer) +
+           Texture::Format::of(postprocessing).getBytesPerPixel();
+}
+
 std::unique_ptr<DeferredShadingTechnique> Renderer::debug_getDeferredTechnique(
       int which) {
-    switch (which % 3) {
+    switch (which % 4) {
         case 0:
             std::cout << "deferred shading using light volumes\n";
             return std::make_unique<LightVolumeTechnique>();
@@ -40,19 +74,28 @@ std::unique_ptr<DeferredShadingTechnique> Renderer::debug_getDeferredTechnique(
         case 2:
             std::cout << "deferred shading using no cleverness\n";
             return std::make_unique<SimpleTechnique>();
+        case 3:
+            std::cout << "deferred shading using clustered lights\n";
+            return std::make_unique<ClusteredTechnique>();
     }
     throw "up";
 }
 
 Renderer::Renderer(Resolution in_resolution,
                    std::unique_ptr<Camera> in_camera,
-                   PostprocessingPipeline in_pipeline)
+                   PostprocessingPipeline in_pipeline,
+                   const TargetFormats& formats)
     : resolution{in_resolution}
     , camera{std::move(in_camera)}
     , clearFlag{GL_COLOR_BUFFER_BIT}
-    , gBuffer{resolution}
-    , postprocessorFramebuffer{PostprocessingStep::createFBO(resolution)}
+    , gBuffer{createGBuffer(resolution, formats)}
+    , postprocessingFormat{checkPostprocessingFormat(formats.postprocessing)}
+    , streamBuffer{std::make_shared<StreamBuffer>(streamBufferCapacity)}
+    , postprocessorFramebuffer{PostprocessingStep::createFBO(
+            resolution,
+            Texture::Format::of(postprocessingFormat))}
     , postprocessor{std::move(in_pipeline)}
+    , outputFramebuffer{screenOutputFramebuffer()}
     , debug_currentDeferredTechnique{0}
     , deferredTechnique{debug_getDeferredTechnique(
             debug_currentDeferredTechnique)}
@@ -61,20 +104,39 @@ Renderer::Renderer(Resolution in_resolution,
 
     setDrawBuffers(gBuffer);
 
-    glEnable(GL_CULL_FACE);
-    GL_CHECK(glCullFace(GL_BACK));
+    GL::FaceCulling::enable();
+    GL::state::cullFace(GL_BACK);
 }
 
 Renderer::~Renderer() = default;
 
 void Renderer::resolutionChanged(Resolution newResolution) {
     this->resolution = newResolution;
-    gBuffer = GBuffer{resolution};
-    postprocessorFramebuffer = PostprocessingStep::createFBO(resolution);
+    gBuffer = GBuffer{resolution, gBuffer.getLayout(), gBuffer.getFormats()};
+    postprocessorFramebuffer = PostprocessingStep::createFBO(
+          resolution, Texture::Format::of(postprocessingFormat));
     setDrawBuffers(gBuffer);
     camera->resolutionChanged(resolution);
 }
 
+void Renderer::setTargetFormats(const TargetFormats& formats) {
+    checkPostprocessingFormat(formats.postprocessing);
+    if (formats.gBufferLayout != gBuffer.getLayout() ||
+        formats.gBuffer != gBuffer.getFormats()) {
+        gBuffer = createGBuffer(resolution, formats);
+        setDrawBuffers(gBuffer);
+    }
+    if (formats.postprocessing != postprocessingFormat) {
+        postprocessingFormat = formats.postprocessing;
+        postprocessorFramebuffer = PostprocessingStep::createFBO(
+              resolution, Texture::Format::of(postprocessingFormat));
+    }
+}
+
+auto Renderer::getTargetFormats() const -> TargetFormats {
+    return {gBuffer.getLayout(), gBuffer.getFormats(), postprocessingFormat};
+}
+
 void Renderer::setBackgroundColor(const Color& color) {
     glClearColor(color.rep().r, color.rep().g, color.rep().b, color.rep().a);
     this->clearColor = color;
@@ -82,43 +144,69 @@ void Renderer::setBackgroundColor(const Color& color) {
 
 void Renderer::setDepthTestEnabled(const bool enabled) {
     if (enabled) {
-        GL_CHECK(glEnable(GL_DEPTH_TEST));
+        GL::DepthTest::enable();
         this->clearFlag |= GL_DEPTH_BUFFER_BIT;
     } else {
-        GL_CHECK(glDisable(GL_DEPTH_TEST));
+        GL::DepthTest::disable();
         this->clearFlag &= ~GL_DEPTH_BUFFER_BIT;
     }
 }
 
 void Renderer::renderScene(Scene& scene) {
+    trace::Scope trace{"render"};
+    GL::state::resetStats();
+    GPUProfiler::beginFrame();
+
     const auto projection = camera->getProjectionMatrix();
     const auto view = camera->getViewMatrix();
+    {
+        trace::Scope trace{"cull"};
+        scene.updateBounds();
+        culler.cull(scene, Frustum{projection * view}, visible);
+    }
+    {
+        trace::Scope trace{"frame uniforms"};
+        frameUniforms.update(scene, visible, view, projection, *streamBuffer);
+    }
 
     GL_CHECK(doGeometryPass(scene, view, projection));
-    GL_CHECK(deferredTechnique->doDeferredPass(
-          this->gBuffer, *postprocessorFramebuffer, scene, view, projection,
-          this->resolution));
+    {
+        trace::Scope trace{"deferred"};
+        GPUProfiler::Scope profile{"deferred"};
+        GL_CHECK(deferredTechnique->doDeferredPass(
+              this->gBuffer, *postprocessorFramebuffer, scene, visible, view,
+              projection, this->resolution));
+    }
     if (needsForwardPass()) {
         GL_CHECK(doForwardPass(scene, view, projection));
     }
 
-    postprocessor->execute(gBuffer,
-                           postprocessorFramebuffer->attachments.mainColor,
-                           screenOutputFramebuffer());
+    {
+        trace::Scope trace{"postprocessing"};
+        GPUProfiler::Scope profile{"postprocessing"};
+        postprocessor->execute(gBuffer,
+                               postprocessorFramebuffer->attachments.mainColor,
+                               outputFramebuffer);
+    }
+
+    GPUProfiler::endFrame();
+    streamBuffer->endFrame();
+    lastFrameStateStats = GL::state::getStats();
 }
 
 void Renderer::doGeometryPass(Scene& scene,
                               const glm::mat4& viewTransform,
                               const glm::mat4& projectionTransform) {
+    trace::Scope trace{"geometry"};
+    GPUProfiler::Scope profile{"geometry"};
     GL_CHECK(gBuffer.bind());
 
     glClearColor(0.f, 0.f, 0.f, 0.f);
     GL_CHECK(glClear(clearFlag));
 
-    for (auto& object : scene.getObjects()) {
-        GL_CHECK(object.setUniforms(viewTransform, projectionTransform));
-        GL_CHECK(object.render());
-    }
+    geometryQueue.build(scene, visible.objects, viewTransform);
+    objectBatcher.draw(scene, geometryQueue.getOrder(), viewTransform,
+                       projectionTransform, streamBuffer);
 }
 
 bool Renderer::needsForwardPass() const {
@@ -128,13 +216,16 @@ bool Renderer::needsForwardPass() const {
 void Renderer::doForwardPass(Scene& scene,
                              const glm::mat4& viewTransform,
                              const glm::mat4& projectionTransform) {
+    trace::Scope trace{"forward"};
+    GPUProfiler::Scope profile{"forward"};
     if (!deferredTechnique->blitsGBufferDepth()) {
         gBuffer.blit(GL_DEPTH_BUFFER_BIT, *postprocessorFramebuffer,
                      resolution);
     }
     const auto viewProjection = projectionTransform * viewTransform;
-    for (auto& light : scene.getPointLights()) {
-        light.debugDraw(viewProjection);
+    auto pointLights = scene.getPointLights();
+    for (const auto i : visible.pointLights) {
+        pointLights[i].debugDraw(viewProjection);
     }
 }
 
@@ -3,9 +3,15 @@
 
 #include "common/common.hpp"
 #include "gl/shader.hpp"
+#include "gl/state.hpp"
+#include "gl/stream_buffer.hpp"
 #include "gl/vertex_array.hpp"
+#include "renderer/culling.hpp"
+#include "renderer/frame_uniforms.hpp"
 #include "renderer/gbuffer.hpp"
+#include "renderer/object_batcher.hpp"
 #include "renderer/postprocessing/postprocessing_step.hpp"
+#include "renderer/render_queue.hpp"
 #include "scene/camera.hpp"
 
 #include <memory>
@@ -18,9 +24,28 @@ struct DeferredShadingTechnique;
 
 class Renderer {
    public:
+    // the formats of the renderer's own targets: the G-buffer's, and the one
+    // the postprocessing pipeline starts from
+    struct TargetFormats {
+        GBuffer::Layout gBufferLayout;
+        GBuffer::Formats gBuffer;
+        // any but RG16F
+        Texture::ColorFormat postprocessing;
+
+        // the layout's default G-buffer formats, and 8 bits per channel for
+        // postprocessing
+        static TargetFormats defaults(
+              GBuffer::Layout layout = GBuffer::Layout::Full);
+        // the G-buffer's plus the postprocessing target's
+        std::size_t getBytesPerPixel() const;
+    };
+
+    // throws GBuffer::unsupported_format and std::invalid_argument if the
+    // formats won't do
     Renderer(Resolution resolution,
              std::unique_ptr<Camera> in_camera,
-             PostprocessingPipeline postprocessor);
+             PostprocessingPipeline postprocessor,
+             const TargetFormats& formats = TargetFormats::defaults());
     ~Renderer();
 
     void renderScene(Scene& scene);
@@ -36,8 +61,39 @@ class Renderer {
 
     void resolutionChanged(Resolution newResolution);
 
+    // where the final, postprocessed image goes. defaults to the window's
+    // default framebuffer; headless contexts have none and must set this.
+    void setOutputFramebuffer(FrameBuffer::View output) {
+        outputFramebuffer = output;
+    }
+
     void setDebugDrawLights(bool d) { debugDrawLights = d; }
 
+    // rebuilds whichever targets change. throws as the constructor does.
+    void setTargetFormats(const TargetFormats& formats);
+    TargetFormats getTargetFormats() const;
+
+    // how many GL state changes the last renderScene issued, and how many
+    // redundant ones it skipped
+    GL::state::Stats getLastFrameStateStats() const {
+        return lastFrameStateStats;
+    }
+    // how many objects and point lights the last renderScene drew, and how
+    // many it culled for being outside the view frustum
+    SceneCuller::Stats getLastFrameCullingStats() const {
+        return culler.getStats();
+    }
+    // how many draw calls the last renderScene's geometry pass made, and how
+    // many objects it drew instanced
+    ObjectBatcher::Stats getLastFrameBatchingStats() const {
+        return objectBatcher.getStats();
+    }
+    // how much per-frame data the last renderScene streamed to the GPU, and
+    // whether it ever had to wait for the GPU to make room
+    StreamBuffer::Stats getLastFrameStreamingStats() const {
+        return streamBuffer->getLastFrameStats();
+    }
+
     void debug_cycleDeferredTechnique();
 
    private:
@@ -54,8 +110,17 @@ class Renderer {
     Color clearColor;
     GLuint clearFlag;
     GBuffer gBuffer;
+    Texture::ColorFormat postprocessingFormat;
+    std::shared_ptr<StreamBuffer> streamBuffer;
+    FrameUniforms frameUniforms;
+    SceneCuller culler;
+    VisibleSet visible;
+    RenderQueue geometryQueue;
+    ObjectBatcher objectBatcher;
     std::unique_ptr<FrameBuffer> postprocessorFramebuffer;
     PostprocessingPipeline postprocessor;
+    FrameBuffer::View outputFramebuffer;
+    GL::state::Stats lastFrameStateStats;
 
     int debug_currentDeferredTechnique;
     std::unique_ptr<DeferredShadingTechnique> deferredTechnique;
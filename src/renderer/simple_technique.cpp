@@ -2,8 +2,9 @@
 #include "common/types.hpp"
 #include "gl/binding.hpp"
 #include "gl/gl.hpp"
+#include "gl/mesh_registry.hpp"
+#include "renderer/frame_uniforms.hpp"
 #include "renderer/gbuffer.hpp"
-#include "scene/scene.hpp"
 
 #include <array>
 
@@ -23,12 +24,17 @@ std::array<Vertex, 6> getFullScreenQuad() {
 }  // namespace
 
 SimpleTechnique::SimpleTechnique()
-    : shader{ShaderSources::withVertAndFrag(
-            fs::loadFileAsString(
-                  fs::RelativePath("shaders/position_texcoord.vert")),
-            fs::loadFileAsString(fs::RelativePath("shaders/deferred.frag")))}
-    , fullscreenQuad{std::make_shared<VertexBuffer>(getFullScreenQuad()),
-                     shader} {}
+    : shader{Shader::compileReloadable([] {
+        return GBuffer::shaderSources(
+              fs::RelativePath("shaders/position_texcoord.vert"),
+              fs::RelativePath("shaders/deferred.frag"));
+    }).take()}
+    , fullscreenQuad{MeshRegistry::get(getFullScreenQuad()),
+                     shader} {
+    // the lights themselves come from the frame's Lights block, and the
+    // inverse projection from its GBuffer block
+    FrameUniforms::bindBlocks(shader);
+}
 
 bool SimpleTechnique::blitsGBufferDepth() const {
     return false;
@@ -36,58 +42,24 @@ bool SimpleTechnique::blitsGBufferDepth() const {
 
 void SimpleTechnique::doDeferredPass(GBuffer& gBuffer,
                                      FrameBuffer::View outputFrameBuffer,
-                                     Scene& scene,
-                                     const glm::mat4& viewTransform,
-                                     const glm::mat4& projectionTransform,
+                                     Scene&,
+                                     const VisibleSet&,
+                                     const glm::mat4&,
+                                     const glm::mat4&,
                                      const Resolution) {
     GL::ScopedDisable<GL::DepthTest> noDepthTest;
 
     setUniforms(gBuffer, shader);
-    setLights(scene, viewTransform, projectionTransform);
 
     outputFrameBuffer.bind();
     glClearColor(0.f, 0.f, 0.f, 0.f);
     glClear(GL_COLOR_BUFFER_BIT);
     RAIIBinding<VertexArrayObject> bind{fullscreenQuad};
-    glDrawArrays(GL_TRIANGLES, 0, fullscreenQuad.getBuffer().getElementCount());
+    glDrawArrays(GL_TRIANGLES, 0, fullscreenQuad.getVertexCount());
 }
 
 void SimpleTechnique::setUniforms(GBuffer& gBuffer, Shader& shader) {
-    auto bindColorTarget = [&](const auto& name, int target) {
-        gBuffer.getColorTarget(target).bind(target);
-        GL_CHECK(shader.setUniform(name, target));
-    };
-    bindColorTarget("positionRGB_specularA",
-                    GBuffer::Target::PositionRGB_SpecularA);
-    bindColorTarget("normalRGB_roughnessA",
-                    GBuffer::Target::NormalRGB_RoughnessA);
-    bindColorTarget("diffuse", GBuffer::Target::Diffuse);
-}
-
-void SimpleTechnique::setLights(Scene& scene,
-                                const glm::mat4& viewTransform,
-                                const glm::mat4& projectionTransform) {
-    {
-        (void)projectionTransform;
-        auto pointLights = scene.getPointLights();
-        for (std::size_t i = 0; i < pointLights.size(); ++i) {
-            GL_CHECK(pointLights[i].applyUniforms(
-                  "pointLights[" + std::to_string(i) + ']', shader,
-                  viewTransform));
-        }
-        shader.setUniform("pointLightCount",
-                          static_cast<int>(pointLights.size()));
-    }
-    {
-        auto directionalLights = scene.getDirectionalLights();
-        for (std::size_t i = 0; i < directionalLights.size(); ++i) {
-            GL_CHECK(directionalLights[i].applyUniforms(
-                  "directionalLights[" + std::to_string(i) + ']', shader,
-                  viewTransform));
-        }
-        shader.setUniform("directionalLightCount",
-                          static_cast<int>(directionalLights.size()));
-    }
+    gBuffer.bindTextures(shader);
 }
 
 NS_KEPLER_END
@@ -13,6 +13,7 @@ struct SimpleTechnique final : public DeferredShadingTechnique {
     void doDeferredPass(GBuffer& gBuffer,
                         FrameBuffer::View outputFrameBuffer,
                         Scene& scene,
+                        const VisibleSet& visible,
                         const glm::mat4& viewTransform,
                         const glm::mat4& projectionTransform,
                         const Resolution resolution) override;
@@ -20,9 +21,6 @@ struct SimpleTechnique final : public DeferredShadingTechnique {
 
    private:
     void setUniforms(GBuffer& gBuffer, Shader& shader);
-    void setLights(Scene& scene,
-                   const glm::mat4& viewTransform,
-                   const glm::mat4& projectionTransform);
 
    private:
     Shader shader;
@@ -0,0 +1,145 @@
+#include "scene/bvh.hpp"
+
+#include <cassert>
+
+NS_KEPLER_BEGIN
+
+constexpr DynamicBVH::Proxy DynamicBVH::nullProxy;
+
+namespace {
+// how much of their size leaves' bounds are padded by on each side
+constexpr float padding = .25f;
+
+AABB padded(const AABB& bounds) {
+    const auto margin = (bounds.max - bounds.min) * padding;
+    return {bounds.min - margin, bounds.max + margin};
+}
+}  // namespace
+
+DynamicBVH::Proxy DynamicBVH::allocate() {
+    if (freeList == nullProxy) {
+        nodes.emplace_back();
+        return static_cast<Proxy>(nodes.size() - 1);
+    }
+    const auto proxy = freeList;
+    freeList = nodes[proxy].parent;
+    nodes[proxy] = Node{};
+    return proxy;
+}
+
+void DynamicBVH::release(Proxy proxy) {
+    nodes[proxy].parent = freeList;
+    freeList = proxy;
+}
+
+DynamicBVH::Proxy DynamicBVH::insert(const AABB& bounds, std::size_t index) {
+    const auto leaf = allocate();
+    nodes[leaf].bounds = padded(bounds);
+    nodes[leaf].index = index;
+    insertLeaf(leaf);
+    ++leafCount;
+    return leaf;
+}
+
+void DynamicBVH::remove(Proxy proxy) {
+    assert(nodes[proxy].isLeaf());
+    removeLeaf(proxy);
+    release(proxy);
+    --leafCount;
+}
+
+bool DynamicBVH::move(Proxy proxy, const AABB& bounds) {
+    assert(nodes[proxy].isLeaf());
+    if (nodes[proxy].bounds.contains(bounds)) {
+        return false;
+    }
+    removeLeaf(proxy);
+    nodes[proxy].bounds = padded(bounds);
+    insertLeaf(proxy);
+    return true;
+}
+
+void DynamicBVH::insertLeaf(Proxy leaf) {
+    if (root == nullProxy) {
+        root = leaf;
+        nodes[root].parent = nullProxy;
+        return;
+    }
+
+    // walk down to the cheapest sibling by the surface area heuristic
+    const auto leafBounds = nodes[leaf].bounds;
+    auto sibling = root;
+    while (!nodes[sibling].isLeaf()) {
+        const auto& node = nodes[sibling];
+        const auto area = node.bounds.getSurfaceArea();
+        const auto combinedArea =
+              AABB::merged(node.bounds, leafBounds).getSurfaceArea();
+        // making a new parent for this node and the leaf
+        const auto cost = 2.f * combinedArea;
+        // the least that pushing the leaf further down costs this node
+        const auto inheritedCost = 2.f * (combinedArea - area);
+        auto descendCost = [&](Proxy child) {
+            const auto& childBounds = nodes[child].bounds;
+            const auto merged =
+                  AABB::merged(childBounds, leafBounds).getSurfaceArea();
+            return inheritedCost +
+                   (nodes[child].isLeaf()
+                          ? merged
+                          : merged - childBounds.getSurfaceArea());
+        };
+        const auto leftCost = descendCost(node.left);
+        const auto rightCost = descendCost(node.right);
+        if (cost < leftCost && cost < rightCost) {
+            break;
+        }
+        sibling = leftCost < rightCost ? node.left : node.right;
+    }
+
+    const auto oldParent = nodes[sibling].parent;
+    const auto newParent = allocate();
+    nodes[newParent].parent = oldParent;
+    nodes[newParent].left = sibling;
+    nodes[newParent].right = leaf;
+    nodes[sibling].parent = newParent;
+    nodes[leaf].parent = newParent;
+    if (oldParent == nullProxy) {
+        root = newParent;
+    } else if (nodes[oldParent].left == sibling) {
+        nodes[oldParent].left = newParent;
+    } else {
+        nodes[oldParent].right = newParent;
+    }
+    refit(newParent);
+}
+
+void DynamicBVH::removeLeaf(Proxy leaf) {
+    if (leaf == root) {
+        root = nullProxy;
+        return;
+    }
+    const auto parent = nodes[leaf].parent;
+    const auto grandparent = nodes[parent].parent;
+    const auto sibling = nodes[parent].left == leaf ? nodes[parent].right
+                                                    : nodes[parent].left;
+    nodes[sibling].parent = grandparent;
+    if (grandparent == nullProxy) {
+        root = sibling;
+    } else {
+        if (nodes[grandparent].left == parent) {
+            nodes[grandparent].left = sibling;
+        } else {
+            nodes[grandparent].right = sibling;
+        }
+        refit(grandparent);
+    }
+    release(parent);
+}
+
+void DynamicBVH::refit(Proxy node) {
+    for (; node != nullProxy; node = nodes[node].parent) {
+        nodes[node].bounds = AABB::merged(nodes[nodes[node].left].bounds,
+                                          nodes[nodes[node].right].bounds);
+    }
+}
+
+NS_KEPLER_END
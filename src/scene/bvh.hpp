@@ -0,0 +1,150 @@
+#ifndef BVH_HPP
+#define BVH_HPP
+
+#include "common/bounds.hpp"
+#include "kepler_config.hpp"
+
+#include <cstddef>
+#include <vector>
+
+NS_KEPLER_BEGIN
+
+// a bounding volume hierarchy that's updated in place as things move, rather
+// than rebuilt. each leaf holds a slightly padded copy of its bounds, so that
+// small movements don't touch the tree at all. queries report leaves by the
+// index they were inserted with, and test only the padded bounds; anything
+// that wants exact answers should check the real bounds of what's reported.
+class DynamicBVH {
+   public:
+    using Proxy = int;
+    static constexpr Proxy nullProxy = -1;
+
+    Proxy insert(const AABB& bounds, std::size_t index);
+    void remove(Proxy proxy);
+    // returns whether the tree had to change, which it doesn't if the new
+    // bounds are still inside the padded ones
+    bool move(Proxy proxy, const AABB& bounds);
+
+    std::size_t size() const { return leafCount; }
+
+    template <typename Callback>
+    void query(const Frustum& frustum, Callback&& callback) const;
+    template <typename Callback>
+    void query(const BoundingSphere& sphere, Callback&& callback) const;
+    // the callback gets each index along with the distance the ray enters its
+    // bounds, in no particular order, and returns the new maximum distance
+    // (return the distance to look only for closer hits, or the old maximum to
+    // find them all)
+    template <typename Callback>
+    void raycast(const Ray& ray, float maxDistance, Callback&& callback) const;
+
+   private:
+    struct Node {
+        AABB bounds;
+        // for nodes on the free list, the next free node
+        Proxy parent = nullProxy;
+        Proxy left = nullProxy;
+        Proxy right = nullProxy;
+        // leaves only
+        std::size_t index = 0;
+
+        bool isLeaf() const { return left == nullProxy; }
+    };
+
+    Proxy allocate();
+    void release(Proxy proxy);
+    void insertLeaf(Proxy leaf);
+    void removeLeaf(Proxy leaf);
+    void refit(Proxy node);
+
+    // Classify returns a Frustum::Containment for a node's bounds. everything
+    // under a node that's entirely inside is reported without more tests.
+    template <typename Classify, typename Callback>
+    void traverse(Classify&& classify, Callback&& callback) const;
+
+    std::vector<Node> nodes;
+    Proxy root = nullProxy;
+    Proxy freeList = nullProxy;
+    std::size_t leafCount = 0;
+};
+
+template <typename Classify, typename Callback>
+void DynamicBVH::traverse(Classify&& classify, Callback&& callback) const {
+    if (root == nullProxy) {
+        return;
+    }
+    struct Entry {
+        Proxy node;
+        bool inside;
+    };
+    std::vector<Entry> stack;
+    stack.reserve(64);
+    stack.push_back({root, false});
+    while (!stack.empty()) {
+        const auto entry = stack.back();
+        stack.pop_back();
+        const auto& node = nodes[entry.node];
+        auto inside = entry.inside;
+        if (!inside) {
+            const auto containment = classify(node.bounds);
+            if (containment == Frustum::Containment::Outside) {
+                continue;
+            }
+            inside = containment == Frustum::Containment::Inside;
+        }
+        if (node.isLeaf()) {
+            callback(node.index);
+        } else {
+            stack.push_back({node.left, inside});
+            stack.push_back({node.right, inside});
+        }
+    }
+}
+
+template <typename Callback>
+void DynamicBVH::query(const Frustum& frustum, Callback&& callback) const {
+    traverse([&](const AABB& bounds) { return frustum.classify(bounds); },
+             callback);
+}
+
+template <typename Callback>
+void DynamicBVH::query(const BoundingSphere& sphere,
+                       Callback&& callback) const {
+    traverse(
+          [&](const AABB& bounds) {
+              return bounds.intersects(sphere)
+                           ? Frustum::Containment::Intersects
+                           : Frustum::Containment::Outside;
+          },
+          callback);
+}
+
+template <typename Callback>
+void DynamicBVH::raycast(const Ray& ray,
+                         float maxDistance,
+                         Callback&& callback) const {
+    if (root == nullProxy) {
+        return;
+    }
+    std::vector<Proxy> stack;
+    stack.reserve(64);
+    stack.push_back(root);
+    while (!stack.empty()) {
+        const auto& node = nodes[stack.back()];
+        stack.pop_back();
+        const auto distance = intersect(ray, node.bounds, maxDistance);
+        if (distance < 0.f) {
+            continue;
+        }
+        if (node.isLeaf()) {
+            maxDistance = callback(node.index, distance);
+        } else {
+            stack.push_back(node.left);
+            stack.push_back(node.right);
+        }
+    }
+}
+
+NS_KEPLER_END
+
+#endif
@@ -0,0 +1,88 @@
+#include "scene/camera_path.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <sstream>
+
+NS_KEPLER_BEGIN
+
+CameraPath CameraPath::load(const fs::AbsolutePath& path) {
+    std::ifstream file{path.get()};
+    if (!file) {
+        throw fs::error_opening_file{path.get()};
+    }
+    CameraPath ret;
+    std::string line;
+    for (std::size_t lineNumber = 1; std::getline(file, line); ++lineNumber) {
+        std::istringstream in{line};
+        char first;
+        if (!(in >> first) || first == '#') {
+            continue;
+        }
+        in.unget();
+        Keyframe key;
+        in >> key.time.rep() >> key.position.x() >> key.position.y() >>
+              key.position.z() >> key.angle.pitch() >> key.angle.yaw() >>
+              key.angle.roll();
+        std::string rest;
+        if (!in || in >> rest ||
+            (!ret.empty() &&
+             key.time.rep() < ret.keyframes.back().time.rep())) {
+            throw parse_error{path.get(), lineNumber};
+        }
+        ret.keyframes.push_back(key);
+    }
+    return ret;
+}
+
+void CameraPath::save(const fs::AbsolutePath& path) const {
+    std::ofstream file{path.get()};
+    if (!file) {
+        throw fs::error_opening_file{path.get()};
+    }
+    file << "# time x y z pitch yaw roll\n";
+    file.precision(std::numeric_limits<float>::max_digits10);
+    for (const auto& key : keyframes) {
+        file << key.time.rep() << ' ' << key.position.x() << ' '
+             << key.position.y() << ' ' << key.position.z() << ' '
+             << key.angle.pitch() << ' ' << key.angle.yaw() << ' '
+             << key.angle.roll() << '\n';
+    }
+}
+
+void CameraPath::addKeyframe(Seconds time, const Transform& transform) {
+    assert(empty() || time.rep() >= keyframes.back().time.rep());
+    keyframes.push_back({time, transform.position, transform.angle});
+}
+
+Seconds CameraPath::getDuration() const {
+    return empty() ? Seconds{0.f} : keyframes.back().time;
+}
+
+void CameraPath::apply(Seconds time, Transform& transform) const {
+    if (empty()) {
+        return;
+    }
+    // the first keyframe after the time
+    const auto next = std::upper_bound(
+          std::begin(keyframes), std::end(keyframes), time.rep(),
+          [](float t, const Keyframe& key) { return t < key.time.rep(); });
+    if (next == std::begin(keyframes) || next == std::end(keyframes)) {
+        const auto& key =
+              next == std::begin(keyframes) ? keyframes.front()
+                                            : keyframes.back();
+        transform.position = key.position;
+        transform.angle = key.angle;
+        return;
+    }
+    const auto& a = *std::prev(next);
+    const auto& b = *next;
+    const auto t = (time.rep() - a.time.rep()) / (b.time.rep() - a.time.rep());
+    transform.position = Point{glm::mix(a.position.rep(), b.position.rep(), t)};
+    transform.angle = Euler{glm::mix(a.angle.rep(), b.angle.rep(), t)};
+}
+
+NS_KEPLER_END
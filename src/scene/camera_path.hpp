@@ -0,0 +1,58 @@
+#ifndef CAMERA_PATH_HPP
+#define CAMERA_PATH_HPP
+
+#include "common/types.hpp"
+#include "data/fs.hpp"
+#include "kepler_config.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+NS_KEPLER_BEGIN
+
+// a camera's transform over time, as keyframes to interpolate between. the
+// demo records them, and the benchmark plays them back.
+//
+// saved as text, a keyframe per line:
+//   time x y z pitch yaw roll
+// with the angles in radians. blank lines and lines starting with '#' are
+// skipped.
+class CameraPath {
+   public:
+    struct parse_error : std::runtime_error {
+        parse_error(const std::string& path, std::size_t line)
+            : std::runtime_error{"bad camera path keyframe at " + path + ':' +
+                                 std::to_string(line)} {}
+    };
+
+    struct Keyframe {
+        Seconds time;
+        Point position;
+        Euler angle;
+    };
+
+    // throws fs::error_opening_file and parse_error
+    static CameraPath load(const fs::AbsolutePath& path);
+    // throws fs::error_opening_file
+    void save(const fs::AbsolutePath& path) const;
+
+    // times must not go backwards
+    void addKeyframe(Seconds time, const Transform& transform);
+    void clear() { keyframes.clear(); }
+
+    bool empty() const { return keyframes.empty(); }
+    // of the last keyframe
+    Seconds getDuration() const;
+
+    // moves and turns the transform to where the path is at the time, holding
+    // the first and last keyframes outside of it. the scale is left alone.
+    void apply(Seconds time, Transform& transform) const;
+
+   private:
+    std::vector<Keyframe> keyframes;
+};
+
+NS_KEPLER_END
+
+#endif
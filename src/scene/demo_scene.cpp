@@ -0,0 +1,146 @@
+#include "scene/demo_scene.hpp"
+
+#include "data/cube.hpp"
+#include "data/fs.hpp"
+#include "data/image.hpp"
+#include "gl/texture.hpp"
+#include "scene/behaviors.hpp"
+#include "scene/light.hpp"
+#include "scene/material.hpp"
+#include "scene/object.hpp"
+#include "util/random.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iterator>
+#include <vector>
+
+NS_KEPLER_BEGIN
+
+namespace {
+template <typename T, std::size_t N>
+std::vector<T> toVec(const std::array<T, N>& arr) {
+    std::vector<T> vec;
+    vec.reserve(N);
+    std::copy(std::begin(arr), std::end(arr), std::back_inserter(vec));
+    return vec;
+}
+
+Object theCube() {
+    auto containerTexture = std::make_shared<Texture>(
+          Image{fs::RelativePath{"res/container2.png"}}, true);
+    auto containerSpecularTexture = std::make_shared<Texture>(
+          Image{fs::RelativePath{"res/container2_specular.png"}}, false);
+    const Material cubeMaterial{containerTexture, containerSpecularTexture,
+                                512.f};
+    return {Transform{Point{0.f, 1.f, -4.f},
+                      Euler{Degrees{0.f}, Degrees{0.f}, Degrees{0.f}},
+                      Scale{1.f, 1.f, 1.f}},
+            toVec(getCubeVerts()), cubeMaterial};
+}
+
+Object randomCube(const Object& startingCube) {
+    using util::random;
+    Object ret = startingCube;
+    ret.transform().position =
+          Point{random(-5.f, 5.f), random(-5.f, 5.f), random(-10.f, 0.f)};
+    ret.transform().scale = Scale{random(0.5f, 1.5f)};
+    if (util::randomBool()) {
+        ret.addBehavior(RotateForeverBehavior{
+              Euler{Degrees{random(-5.f, 5.f)}, Degrees{random(-5.f, 5.f)},
+                    Degrees{random(-5.f, 5.f)}}});
+    }
+    return ret;
+}
+
+Object theFloor() {
+    Texture::Params params;
+    params.wrapS = params.wrapT = Texture::Wrap::Repeat;
+    auto containerTexture = std::make_shared<Texture>(
+          Image{fs::RelativePath{"res/Tiles_016_basecolor.jpg"}}, true,
+          params);
+    auto containerSpecularTexture = std::make_shared<Texture>(
+          Image{fs::RelativePath{"res/Tiles_016_roughness.jpg"}}, false,
+          params);
+    const Material floorMaterial{containerTexture, containerSpecularTexture,
+                                 256.f};
+
+    constexpr auto size = 20.f;
+    auto verts = {
+          Vertex{{-1.f, 0.f, -1.f}, {0.f, 1.f, 0.f}, {0.f, 0.f}, {}},
+          Vertex{{-1.f, 0.f, +1.f}, {0.f, 1.f, 0.f}, {size, 0.f}, {}},
+          Vertex{{+1.f, 0.f, -1.f}, {0.f, 1.f, 0.f}, {0.f, size}, {}},
+          Vertex{{+1.f, 0.f, -1.f}, {0.f, 1.f, 0.f}, {0.f, size}, {}},
+          Vertex{{-1.f, 0.f, +1.f}, {0.f, 1.f, 0.f}, {size, 0.f}, {}},
+          Vertex{{+1.f, 0.f, +1.f}, {0.f, 1.f, 0.f}, {size, size}, {}},
+    };
+    return {
+          Transform{Point{0.f, -2.f, 0.f}, Euler{}, Scale{size, 1.f, size}},
+          verts,
+          floorMaterial,
+    };
+}
+
+PointLight randomLight() {
+    using util::random;
+    constexpr auto areaSize = 10.f;
+    constexpr auto areaVertOffset = 5.f;
+    auto randomPoint = [&] {
+        return Point{random(-areaSize, areaSize),
+                     random(-areaSize, areaSize) + areaVertOffset,
+                     random(-areaSize, areaSize)};
+    };
+    auto randomColor = [&] {
+        return ColorRGB{util::randomOnUnitSphere() * 0.333f +
+                        glm::vec3{0.667f}};
+    };
+    const auto lightColor = randomColor();
+    auto theLight = PointLight{
+          Transform{randomPoint(), Euler{}, Scale{2.5f}},
+          Light_base::Colors{ColorRGB{0.1f, 0.1f, 0.1f}, lightColor,
+                             lightColor},
+          PointLight::Radius{random(2.5f, 7.5f)},
+    };
+    if (util::randomBool(0.2f)) {
+        theLight.addBehavior(PulseBehavior{random(0.f, 2.f)});
+    }
+    return theLight;
+}
+
+DirectionalLight directionalLight(std::size_t index) {
+    const Light_base::Colors colors{
+          {0.f, 0.f, 0.f}, {0.05f, 0.05f, 0.05f}, {0.1f, 0.05f, 0.05f}};
+    if (index == 0) {
+        return {Direction{0.f, -1.f, 0.f}, colors};
+    }
+    // always from above, so it still reaches the floor
+    auto direction = util::randomOnUnitSphere();
+    direction.y = -std::abs(direction.y) - 0.1f;
+    return {Direction{direction}, colors};
+}
+}  // namespace
+
+std::unique_ptr<Scene> makeDemoScene(const DemoSceneParams& params) {
+    const auto cube = theCube();
+    std::vector<Object> cubes{cube};
+    cubes.reserve(1 + params.objects);
+    std::generate_n(std::back_inserter(cubes), params.objects,
+                    [&] { return randomCube(cube); });
+
+    std::vector<PointLight> lights;
+    lights.reserve(params.pointLights);
+    std::generate_n(std::back_inserter(lights), params.pointLights,
+                    randomLight);
+
+    auto scene =
+          std::make_unique<Scene>(std::move(cubes), std::move(lights),
+                                  std::vector<DirectionalLight>{});
+    scene->addObject(theFloor());
+    for (std::size_t i = 0; i < params.directionalLights; ++i) {
+        scene->addDirectionalLight(directionalLight(i));
+    }
+    return scene;
+}
+
+NS_KEPLER_END
@@ -0,0 +1,28 @@
+#ifndef DEMO_SCENE_HPP
+#define DEMO_SCENE_HPP
+
+#include "kepler_config.hpp"
+#include "scene/scene.hpp"
+
+#include <cstddef>
+#include <memory>
+
+NS_KEPLER_BEGIN
+
+// the scene the demo and the benchmark render: randomly placed crates over a
+// tiled floor, lit by randomly placed point lights. everything random comes
+// from util::random, so reseeding it first gives the same scene every time.
+struct DemoSceneParams {
+    // crates, besides the first one and the floor
+    std::size_t objects = 200;
+    std::size_t pointLights = 63;
+    // the first points straight down, and the rest in random directions
+    std::size_t directionalLights = 1;
+};
+
+std::unique_ptr<Scene> makeDemoScene(
+      const DemoSceneParams& params = DemoSceneParams{});
+
+NS_KEPLER_END
+
+#endif
@@ -1,17 +1,20 @@
 #include "scene/light.hpp"
 #include "data/cube.hpp"
+#include "gl/mesh_registry.hpp"
 #include "gl/shader.hpp"
 #include "gl/vertex_array.hpp"
 
 NS_KEPLER_BEGIN
 
-void Light_base::applyUniforms(const std::string& name,
-                               Shader& shader,
-                               const glm::mat4& viewTransform) const {
-    shader.setUniform(name + ".ambient", this->colors.ambient.rep());
-    shader.setUniform(name + ".diffuse", this->colors.diffuse.rep());
-    shader.setUniform(name + ".specular", this->colors.specular.rep());
-    applyAdditionalUniforms(name, shader, viewTransform);
+Light_base::Uniforms::Uniforms(const Shader& shader, const std::string& name)
+    : ambient{shader.getUniform(name + ".ambient")}
+    , diffuse{shader.getUniform(name + ".diffuse")}
+    , specular{shader.getUniform(name + ".specular")} {}
+
+void Light_base::applyUniforms(const Uniforms& uniforms, Shader& shader) const {
+    shader.setUniform(uniforms.ambient, this->colors.ambient.rep());
+    shader.setUniform(uniforms.diffuse, this->colors.diffuse.rep());
+    shader.setUniform(uniforms.specular, this->colors.specular.rep());
 }
 
 //
@@ -24,14 +27,22 @@ PointLight::PointLight(const Transform& transform,
     , radius{in_radius}
     , debugDrawData{getDebugDrawData} {}
 
-void PointLight::applyAdditionalUniforms(const std::string& name,
-                                         Shader& shader,
-                                         const glm::mat4& viewTransform) const {
-    shader.setUniform(
-          name + ".position",
-          glm::vec3{viewTransform *
-                    glm::vec4{this->transform().position.rep(), 1.f}});
-    shader.setUniform(name + ".radius", radius.rep());
+PointLight::Uniforms::Uniforms(const Shader& shader, const std::string& name)
+    : Light_base::Uniforms{shader, name}
+    , position{shader.getUniform(name + ".position")}
+    , radius{shader.getUniform(name + ".radius")} {}
+
+void PointLight::applyUniforms(const Uniforms& uniforms,
+                               Shader& shader,
+                               const glm::mat4& viewTransform) const {
+    Light_base::applyUniforms(uniforms, shader);
+    shader.setUniform(uniforms.position, getViewPosition(viewTransform));
+    shader.setUniform(uniforms.radius, radius.rep());
+}
+
+glm::vec3 PointLight::getViewPosition(const glm::mat4& viewTransform) const {
+    return glm::vec3{viewTransform *
+                     glm::vec4{this->transform().position.rep(), 1.f}};
 }
 
 glm::mat4 PointLight::getVolumeModelMatrix() const {
@@ -46,7 +57,7 @@ void PointLight::debugDraw(const glm::mat4& viewProjectionTransform) {
     data.shader->setUniform("mvp",
                             viewProjectionTransform * getVolumeModelMatrix());
     data.shader->setUniform("color", this->colors.diffuse.rep());
-    glDrawArrays(GL_LINES, 0, data.vao->getBuffer().getElementCount());
+    glDrawArrays(GL_LINES, 0, data.vao->getVertexCount());
 }
 
 auto PointLight::getDebugDrawData() -> DebugDrawData {
@@ -54,20 +65,28 @@ auto PointLight::getDebugDrawData() -> DebugDrawData {
     theData.shader = Shader::create(fs::RelativePath{"shaders/light.vert"},
                                     fs::RelativePath{"shaders/light.frag"});
     theData.vao = std::make_shared<VertexArrayObject>(
-          std::make_shared<VertexBuffer>(getCubeVerts()), *theData.shader);
+          MeshRegistry::get(getCubeVerts()), *theData.shader);
     return theData;
 }
 
 //
 
-void DirectionalLight::applyAdditionalUniforms(
-      const std::string& name,
-      Shader& shader,
+DirectionalLight::Uniforms::Uniforms(const Shader& shader,
+                                    const std::string& name)
+    : Light_base::Uniforms{shader, name}
+    , direction{shader.getUniform(name + ".direction")} {}
+
+void DirectionalLight::applyUniforms(const Uniforms& uniforms,
+                                     Shader& shader,
+                                     const glm::mat4& viewTransform) const {
+    Light_base::applyUniforms(uniforms, shader);
+    shader.setUniform(uniforms.direction, getViewDirection(viewTransform));
+}
+
+glm::vec3 DirectionalLight::getViewDirection(
       const glm::mat4& viewTransform) const {
-    shader.setUniform(
-          name + ".direction",
-          glm::normalize(-glm::vec3{viewTransform *
-                                    glm::vec4{this->direction.rep(), 0.f}}));
+    return glm::normalize(
+          -glm::vec3{viewTransform * glm::vec4{this->direction.rep(), 0.f}});
 }
 
 NS_KEPLER_END
@@ -1,7 +1,9 @@
 #ifndef LIGHT_HPP
 #define LIGHT_HPP
 
+#include "common/bounds.hpp"
 #include "common/types.hpp"
+#include "gl/shader.hpp"
 #include "scene/behavior.hpp"
 #include "util/lazy.hpp"
 
@@ -10,7 +12,6 @@
 
 NS_KEPLER_BEGIN
 
-class Shader;
 struct VertexArrayObject;
 
 struct Light_base {
@@ -25,15 +26,13 @@ struct Light_base {
 
     Colors colors;
 
-    void applyUniforms(const std::string& name,
-                       Shader& shader,
-                       const glm::mat4& viewTransform) const;
+    struct Uniforms {
+        Uniforms(const Shader& shader, const std::string& name);
+        Shader::Uniform ambient, diffuse, specular;
+    };
 
    protected:
-    virtual void applyAdditionalUniforms(
-          const std::string& name,
-          Shader& shader,
-          const glm::mat4& viewTransform) const = 0;
+    void applyUniforms(const Uniforms& uniforms, Shader& shader) const;
 };
 
 struct PointLight
@@ -50,10 +49,24 @@ struct PointLight
 
     Radius radius;
 
+    struct Uniforms : Light_base::Uniforms {
+        Uniforms(const Shader& shader, const std::string& name);
+        Shader::Uniform position, radius;
+    };
+    void applyUniforms(const Uniforms& uniforms,
+                       Shader& shader,
+                       const glm::mat4& viewTransform) const;
+    glm::vec3 getViewPosition(const glm::mat4& viewTransform) const;
+
     void debugDraw(const glm::mat4& viewProjectionTransform);
 
     glm::mat4 getVolumeModelMatrix() const;
 
+    // everything the light reaches, in world space
+    BoundingSphere getBoundingSphere() const {
+        return {transform().position.rep(), radius.rep()};
+    }
+
     PointLight& getActor() override { return *this; }
 
    private:
@@ -63,10 +76,6 @@ struct PointLight
     };
     static DebugDrawData getDebugDrawData();
     util::Lazy<DebugDrawData, DebugDrawData (*)()> debugDrawData;
-
-    void applyAdditionalUniforms(const std::string& name,
-                                 Shader& shader,
-                                 const glm::mat4& viewTransform) const override;
 };
 
 struct DirectionalLight
@@ -82,14 +91,20 @@ struct DirectionalLight
         direction = {glm::normalize(newDirection.rep())};
     }
 
+    struct Uniforms : Light_base::Uniforms {
+        Uniforms(const Shader& shader, const std::string& name);
+        Shader::Uniform direction;
+    };
+    void applyUniforms(const Uniforms& uniforms,
+                       Shader& shader,
+                       const glm::mat4& viewTransform) const;
+    // points towards the light
+    glm::vec3 getViewDirection(const glm::mat4& viewTransform) const;
+
     DirectionalLight& getActor() override { return *this; }
 
    private:
     Direction direction;
-
-    void applyAdditionalUniforms(const std::string& name,
-                                 Shader& shader,
-                                 const glm::mat4& viewTransform) const override;
 };
 
 NS_KEPLER_END
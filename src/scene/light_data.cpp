@@ -1,54 +1,80 @@
 #include "scene/light_data.hpp"
 #include "scene/light.hpp"
 #include "scene/scene.hpp"
-#include "util/invoke_result.hpp"
+
+#include <algorithm>
 
 NS_KEPLER_BEGIN
 
 namespace {
-template <typename Fn,
-          typename AttributeType = util::invoke_result_t<Fn, const PointLight&>>
-std::shared_ptr<VertexAttributeBuffer<AttributeType>>
-getPointLightsAttributeBuffer(const Scene& scene, Fn fn) {
-    std::vector<AttributeType> attributes;
-    const auto pointLights = scene.getPointLights();
-    attributes.reserve(pointLights.size());
-    std::transform(std::begin(pointLights), std::end(pointLights),
-                   std::back_inserter(attributes), fn);
-    return std::make_shared<VertexAttributeBuffer<AttributeType>>(attributes);
+// changed lights with no more than this many unchanged ones between them are
+// uploaded together, rather than paying for another glBufferSubData
+constexpr std::size_t maxCoalescedGap = 8;
+
+LightData::PointLightInstance getInstance(const PointLight& light) {
+    return {light.transform().position.rep(), light.radius.rep(),
+            light.colors.ambient.rep(), light.colors.diffuse.rep(),
+            light.colors.specular.rep()};
+}
+
+std::shared_ptr<LightData::PointLightInstanceBuffer> makeBuffer() {
+    return std::make_shared<LightData::PointLightInstanceBuffer>();
 }
 }  // namespace
 
+bool LightData::PointLightInstance::operator==(
+      const PointLightInstance& other) const {
+    return position == other.position && radius == other.radius &&
+           ambientColor == other.ambientColor &&
+           diffuseColor == other.diffuseColor &&
+           specularColor == other.specularColor;
+}
+
 LightData::LightData(const Scene& in_scene)
-    : scene{in_scene}
-    , pointLightPositionsBuffer{[this] {
-        return getPointLightsAttributeBuffer(
-              scene, [](const PointLight& light) {
-                  return light.transform().position.rep();
-              });
-    }}
-    , pointLightRadiiBuffer{[this] {
-        return getPointLightsAttributeBuffer(
-              scene,
-              [](const PointLight& light) { return light.radius.rep(); });
-    }}
-    , pointLightAmbientColorBuffer{[this] {
-        return getPointLightsAttributeBuffer(
-              scene, [](const PointLight& light) {
-                  return light.colors.ambient.rep();
-              });
-    }}
-    , pointLightDiffuseColorBuffer{[this] {
-        return getPointLightsAttributeBuffer(
-              scene, [](const PointLight& light) {
-                  return light.colors.diffuse.rep();
-              });
-    }}
-    , pointLightSpecularColorBuffer{[this] {
-        return getPointLightsAttributeBuffer(
-              scene, [](const PointLight& light) {
-                  return light.colors.specular.rep();
-              });
-    }} {}
+    : scene{in_scene}, pointLightBuffer{makeBuffer} {}
+
+void LightData::update() {
+    const auto& pointLights = scene.get().getPointLights();
+    const auto count = pointLights.size();
+    auto& buffer = *pointLightBuffer.get();
+
+    if (count > buffer.getElementCount()) {
+        uploaded.clear();
+        std::transform(std::begin(pointLights), std::end(pointLights),
+                       std::back_inserter(uploaded), getInstance);
+        // grow geometrically, so adding lights one at a time doesn't
+        // reallocate every time
+        auto storage = uploaded;
+        storage.resize(std::max(count, 2 * buffer.getElementCount()));
+        buffer.setData(storage, GL_DYNAMIC_DRAW);
+        return;
+    }
+
+    // lights past what was uploaded last time are new, so they always count as
+    // changed
+    const auto previousCount = uploaded.size();
+    uploaded.resize(count);
+
+    std::size_t dirtyBegin = 0, dirtyEnd = 0;
+    auto flush = [&] {
+        if (dirtyEnd > dirtyBegin) {
+            buffer.updateData(dirtyBegin, dirtyEnd - dirtyBegin,
+                              uploaded.data() + dirtyBegin);
+        }
+    };
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto instance = getInstance(pointLights[i]);
+        if (i < previousCount && instance == uploaded[i]) {
+            continue;
+        }
+        uploaded[i] = instance;
+        if (dirtyEnd == dirtyBegin || i - dirtyEnd > maxCoalescedGap) {
+            flush();
+            dirtyBegin = i;
+        }
+        dirtyEnd = i + 1;
+    }
+    flush();
+}
 
 NS_KEPLER_END
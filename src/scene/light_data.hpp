@@ -2,47 +2,59 @@
 #define LIGHT_DATA_HPP
 
 #include "common/common.hpp"
+#include "common/types.hpp"
 #include "gl/buffer.hpp"
 #include "util/lazy.hpp"
 
+#include <cstddef>
 #include <functional>
 #include <memory>
 #include <vector>
 
 NS_KEPLER_BEGIN
 
-struct DirectionalLight;
 struct PointLight;
 class Scene;
 
+// per-instance attributes for drawing every point light in the scene in one
+// instanced draw call. the GPU copy is kept up to date incrementally: only the
+// lights that changed since the last update are re-uploaded.
 class LightData {
    public:
-    LightData(const Scene& in_scene);
+    // interleaved, one per point light
+    struct PointLightInstance {
+        glm::vec3 position;
+        float radius;
+        glm::vec3 ambientColor;
+        glm::vec3 diffuseColor;
+        glm::vec3 specularColor;
+
+        bool operator==(const PointLightInstance& other) const;
+        bool operator!=(const PointLightInstance& other) const {
+            return !(*this == other);
+        }
+    };
+    using PointLightInstanceBuffer = VertexAttributeBuffer<PointLightInstance>;
 
-   private:
-    std::reference_wrapper<const Scene> scene;
+    LightData(const Scene& in_scene);
 
-   public:
-#define POINT_LIGHT_DATA_LAZY_BUFFER(TYPE, BUFFERNAME)       \
-   public:                                                   \
-    const std::shared_ptr<VertexAttributeBuffer<TYPE>>&      \
-          getPointLight##BUFFERNAME##Buffer() const {        \
-        return pointLight##BUFFERNAME##Buffer;               \
-    }                                                        \
-                                                             \
-   private:                                                  \
-    util::Lazy<std::shared_ptr<VertexAttributeBuffer<TYPE>>> \
-          pointLight##BUFFERNAME##Buffer;                    \
-                                                             \
-   public:
+    // brings the buffer up to date with the scene's point lights. cheap when
+    // nothing has changed, so it's fine to call more than once per frame.
+    void update();
 
-    POINT_LIGHT_DATA_LAZY_BUFFER(glm::vec3, Positions)
-    POINT_LIGHT_DATA_LAZY_BUFFER(float, Radii)
-    POINT_LIGHT_DATA_LAZY_BUFFER(glm::vec3, AmbientColor)
-    POINT_LIGHT_DATA_LAZY_BUFFER(glm::vec3, DiffuseColor)
-    POINT_LIGHT_DATA_LAZY_BUFFER(glm::vec3, SpecularColor)
+    // may hold more elements than there are lights
+    const std::shared_ptr<PointLightInstanceBuffer>& getPointLightBuffer()
+          const {
+        return pointLightBuffer;
+    }
 
-#undef POINT_LIGHT_DATA_LAZY_BUFFER
+   private:
+    std::reference_wrapper<const Scene> scene;
+    // what the buffer currently holds, to find out what's changed
+    std::vector<PointLightInstance> uploaded;
+    util::Lazy<std::shared_ptr<PointLightInstanceBuffer>,
+               std::shared_ptr<PointLightInstanceBuffer> (*)()>
+          pointLightBuffer;
 };
 
 NS_KEPLER_END
@@ -1,4 +1,19 @@
 #include "scene/material.hpp"
 
 NS_KEPLER_BEGIN
+
+Material::Uniforms::Uniforms(const Shader& shader, const std::string& name)
+    : diffuse{shader.getUniform(name + ".diffuse")}
+    , specular{shader.getUniform(name + ".specular")}
+    , shininess{shader.getUniform(name + ".shininess")} {}
+
+void Material::applyUniforms(const Uniforms& uniforms, Shader& shader) const {
+    shader.bind();
+    this->diffuse->bind(TextureUnit::Diffuse);
+    shader.setUniform(uniforms.diffuse, TextureUnit::Diffuse);
+    this->specular->bind(TextureUnit::Specular);
+    shader.setUniform(uniforms.specular, TextureUnit::Specular);
+    shader.setUniform(uniforms.shininess, this->shininess);
+}
+
 NS_KEPLER_END
@@ -2,10 +2,12 @@
 #define MATERIAL_HPP
 
 #include "common/types.hpp"
+#include "gl/shader.hpp"
 #include "gl/texture.hpp"
 #include "kepler_config.hpp"
 
 #include <memory>
+#include <string>
 
 NS_KEPLER_BEGIN
 
@@ -21,6 +23,12 @@ struct Material {
         };
         TextureUnit() = delete;
     };
+
+    struct Uniforms {
+        Uniforms(const Shader& shader, const std::string& name);
+        Shader::Uniform diffuse, specular, shininess;
+    };
+    void applyUniforms(const Uniforms& uniforms, Shader& shader) const;
 };
 
 NS_KEPLER_END
@@ -1,18 +1,40 @@
 #include "scene/object.hpp"
 #include "data/fs.hpp"
+#include "gl/mesh_registry.hpp"
+#include "renderer/frame_uniforms.hpp"
+#include "renderer/gbuffer.hpp"
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 
 NS_KEPLER_BEGIN
 
 namespace {
+std::shared_ptr<VertexArrayObject> makeVertexArray(
+      const std::vector<Vertex>& vertices,
+      Shader& shader) {
+    // compact vertices have no color, which reads as white
+    const auto white = Color{}.rep();
+    const bool allWhite = std::all_of(
+          std::begin(vertices), std::end(vertices),
+          [&](const Vertex& v) { return v.color.rep() == white; });
+    if (allWhite) {
+        return std::make_shared<VertexArrayObject>(
+              MeshRegistry::getIndexed<CompactVertex>(vertices), shader);
+    }
+    return std::make_shared<VertexArrayObject>(
+          MeshRegistry::getIndexed(vertices), shader);
+}
+
 std::shared_ptr<Shader> phongShader() {
     static const fs::AbsolutePath vertPath =
           fs::RelativePath{"shaders/phong.vert"};
     static const fs::AbsolutePath fragPath =
           fs::RelativePath{"shaders/phong.frag"};
-    auto shader = Shader::create(vertPath, fragPath);
+    auto shader = Shader::createReloadable(
+          [] { return GBuffer::shaderSources(vertPath, fragPath); });
+    FrameUniforms::bindBlocks(*shader);
     GL_CHECK();
     return shader;
 }
@@ -27,31 +49,35 @@ MeshRenderable::MeshRenderable(const Transform& transform,
                                std::shared_ptr<Shader> shader,
                                const std::vector<Vertex>& vertices)
     : Renderable{transform, std::move(shader)}
-    , vao{std::make_shared<VertexArrayObject>(
-            std::make_shared<VertexBuffer>(vertices),
-            *this->shader)} {}
+    , vao{makeVertexArray(vertices, *this->shader)}
+    , localBounds{AABB::fromVertices(vertices)} {}
 
 Object::Object(const Transform& transform,
                const std::vector<Vertex>& vertices,
                Material mat)
     : MeshRenderable{transform, phongShader(), vertices}
-    , material{std::move(mat)} {}
+    , material{std::move(mat)}
+    , uniforms{*this->shader} {}
+
+Object::Uniforms::Uniforms(const Shader& shader)
+    : modelView{shader.getUniform("modelView")}
+    , normalMatrix{shader.getUniform("normalMatrix")}
+    , material{shader, "material"} {}
 
 void Object::setUniformsImpl(const glm::mat4& model,
                              const glm::mat4& view,
-                             const glm::mat4& projection) {
+                             const glm::mat4&) {
+    // the projection comes from the frame's Camera block
     shader->bind();
     const auto modelView = view * model;
-    shader->setUniform("modelView", modelView);
-    shader->setUniform("projection", projection);
-    shader->setUniform("normalMatrix", matrix::normal(modelView));
-    shader->setUniform("material", this->material);
+    shader->setUniform(uniforms.modelView, modelView);
+    shader->setUniform(uniforms.normalMatrix, matrix::normal(modelView));
+    this->material.applyUniforms(uniforms.material, *shader);
 }
 
 void Object::render() {
     shader->bind();
-    vao->bind();
-    glDrawArrays(GL_TRIANGLES, 0, vao->getBuffer().getElementCount());
+    GL_CHECK(vao->draw());
 }
 
 std::string Object::toString() const {
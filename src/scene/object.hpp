@@ -1,6 +1,7 @@
 #ifndef OBJECT_HPP
 #define OBJECT_HPP
 
+#include "common/bounds.hpp"
 #include "common/types.hpp"
 #include "gl/shader.hpp"
 #include "gl/vertex_array.hpp"
@@ -20,6 +21,8 @@ class Renderable : public Transformed {
     void setUniforms(const glm::mat4& view, const glm::mat4& projection);
     virtual void render() = 0;
 
+    const Shader& getShader() const { return *shader; }
+
    protected:
     Renderable(const Transform& transform, std::shared_ptr<Shader> in_shader)
         : Transformed{transform}, shader{std::move(in_shader)} {}
@@ -36,8 +39,19 @@ class MeshRenderable : public Renderable {
                    std::shared_ptr<Shader> shader,
                    const std::vector<Vertex>& vertices);
 
+    // in world space
+    BoundingSphere getBoundingSphere() const {
+        return transformed(localBounds.getBoundingSphere(), transform());
+    }
+    AABB getBounds() const {
+        return transformed(localBounds, getModelMatrix());
+    }
+
+    const VertexArrayObject& getVertexArray() const { return *vao; }
+
    protected:
     std::shared_ptr<VertexArrayObject> vao;
+    AABB localBounds;
 };
 
 class Object
@@ -52,6 +66,8 @@ class Object
 
     std::string toString() const;
 
+    const Material& getMaterial() const { return material; }
+
     Object& getActor() override { return *this; }
 
    protected:
@@ -60,6 +76,14 @@ class Object
                          const glm::mat4& projection) override;
 
     Material material;
+
+   private:
+    struct Uniforms {
+        explicit Uniforms(const Shader& shader);
+        Shader::Uniform modelView, normalMatrix;
+        Material::Uniforms material;
+    };
+    Uniforms uniforms;
 };
 
 NS_KEPLER_END
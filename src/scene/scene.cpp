@@ -1,10 +1,12 @@
 #include "scene/scene.hpp"
+#include "util/trace.hpp"
 
 #include <sstream>
 
 NS_KEPLER_BEGIN
 
 void Scene::update(Seconds dt) {
+    trace::Scope trace{"scene update"};
     for (auto& object : objects) {
         object.update(dt);
     }
@@ -14,6 +16,47 @@ void Scene::update(Seconds dt) {
     for (auto& light : directionalLights) {
         light.update(dt);
     }
+    updateBounds();
+}
+
+void Scene::updateBounds() {
+    for (std::size_t i = 0; i < objects.size(); ++i) {
+        if (objects[i].checkTransformChanged()) {
+            objectTree.move(objectProxies[i], objects[i].getBounds());
+        }
+    }
+}
+
+void Scene::addObjectBounds(std::size_t index) {
+    objects[index].checkTransformChanged();
+    objectProxies.push_back(
+          objectTree.insert(objects[index].getBounds(), index));
+}
+
+std::vector<std::size_t> Scene::getObjectsTouching(
+      const BoundingSphere& sphere) const {
+    std::vector<std::size_t> touching;
+    objectTree.query(sphere, [&](std::size_t i) {
+        if (objects[i].getBounds().intersects(sphere)) {
+            touching.push_back(i);
+        }
+    });
+    return touching;
+}
+
+auto Scene::raycast(const Ray& ray, float maxDistance) const
+      -> util::optional<RayHit> {
+    util::optional<RayHit> closest;
+    objectTree.raycast(ray, maxDistance, [&](std::size_t i, float) {
+        const auto distance = intersect(ray, objects[i].getBounds(),
+                                        closest ? closest->distance
+                                                : maxDistance);
+        if (distance >= 0.f) {
+            closest = RayHit{i, distance};
+        }
+        return closest ? closest->distance : maxDistance;
+    });
+    return closest;
 }
 
 void Scene::startAll() {
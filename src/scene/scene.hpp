@@ -1,12 +1,16 @@
 #ifndef SCENE_HPP
 #define SCENE_HPP
 
+#include "common/bounds.hpp"
 #include "kepler_config.hpp"
+#include "scene/bvh.hpp"
 #include "scene/light.hpp"
 #include "scene/light_data.hpp"
 #include "scene/object.hpp"
+#include "util/optional.hpp"
 #include "util/util.hpp"
 
+#include <cstddef>
 #include <string>
 #include <utility>
 #include <vector>
@@ -25,11 +29,15 @@ class Scene
         , directionalLights{std::move(in_directionalLights)}
         , lightData{*this} {
         startAll();
+        for (std::size_t i = 0; i < objects.size(); ++i) {
+            addObjectBounds(i);
+        }
     }
 
     void addObject(Object o) {
         objects.push_back(std::move(o));
         objects.back().start();
+        addObjectBounds(objects.size() - 1);
     }
     void addPointLight(PointLight l) {
         pointLights.push_back(std::move(l));
@@ -58,17 +66,41 @@ class Scene
 
     void update(Seconds dt);
 
+    // brings the spatial queries up to date with any objects that have moved.
+    // update() does this already, so this is only needed after moving objects
+    // some other way.
+    void updateBounds();
+
+    // these report objects by their index in getObjects(). the frustum query
+    // is conservative, and may report objects just outside the frustum.
+    template <typename Callback>
+    void forEachObjectIn(const Frustum& frustum, Callback&& callback) const {
+        objectTree.query(frustum, std::forward<Callback>(callback));
+    }
+    std::vector<std::size_t> getObjectsTouching(
+          const BoundingSphere& sphere) const;
+    struct RayHit {
+        std::size_t object;
+        float distance;
+    };
+    // against the objects' bounding boxes
+    util::optional<RayHit> raycast(const Ray& ray, float maxDistance) const;
+
     std::string toString() const;
 
+    LightData& getLightData() { return lightData; }
     const LightData& getLightData() const { return lightData; }
 
    private:
     void startAll();
+    void addObjectBounds(std::size_t index);
 
     std::vector<Object> objects;
     std::vector<PointLight> pointLights;
     std::vector<DirectionalLight> directionalLights;
     LightData lightData;
+    DynamicBVH objectTree;
+    std::vector<DynamicBVH::Proxy> objectProxies;
 };
 
 NS_KEPLER_END
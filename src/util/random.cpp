@@ -4,4 +4,8 @@ NS_KEPLER_BEGIN
 
 std::mt19937 util::detail::random::engine{std::random_device{}()};
 
+void util::seedRandom(std::uint32_t seed) {
+    detail::random::engine.seed(seed);
+}
+
 NS_KEPLER_END
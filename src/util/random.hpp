@@ -4,6 +4,7 @@
 #include "common/types.hpp"
 #include "kepler_config.hpp"
 
+#include <cstdint>
 #include <random>
 #include <type_traits>
 
@@ -16,6 +17,10 @@ extern std::mt19937 engine;
 }
 }  // namespace detail
 
+// the engine starts from a nondeterministic seed. reseed it to get the same
+// numbers every run.
+void seedRandom(std::uint32_t seed);
+
 template <typename Int>
 std::enable_if_t<std::is_integral<Int>::value, Int> random(Int min, Int max) {
     return std::uniform_int_distribution<Int>{min, max}(detail::random::engine);
@@ -0,0 +1,179 @@
+#include "util/trace.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+NS_KEPLER_BEGIN
+
+namespace {
+constexpr std::size_t eventsPerThread = 1 << 16;
+
+struct Event {
+    const char* name;
+    std::int64_t begin;
+    std::int64_t end;
+};
+
+// written only by its own thread. a reader sees every event up to size.
+struct ThreadBuffer {
+    explicit ThreadBuffer(std::size_t in_id)
+        : id{in_id}, events{new Event[eventsPerThread]} {}
+
+    std::size_t id;
+    std::unique_ptr<Event[]> events;
+    std::atomic<std::size_t> size{0};
+    std::atomic<std::size_t> dropped{0};
+    // the capture the events belong to
+    std::atomic<std::uint64_t> capture{0};
+};
+
+// taken once per thread, to register its buffer, and when writing the JSON
+std::mutex buffersMutex;
+std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+
+std::atomic<std::uint64_t> currentCapture{0};
+
+// only touched by the thread that marks frames
+bool capturePending = false;
+std::size_t framesToCapture = 0;
+std::size_t framesLeft = 0;
+std::int64_t lastFrameMark = 0;
+
+ThreadBuffer& getThreadBuffer() {
+    thread_local ThreadBuffer* buffer = nullptr;
+    if (!buffer) {
+        std::lock_guard<std::mutex> lock{buffersMutex};
+        buffers.push_back(std::make_unique<ThreadBuffer>(buffers.size()));
+        buffer = buffers.back().get();
+    }
+    return *buffer;
+}
+
+const auto startTime = std::chrono::steady_clock::now();
+
+void writeEscaped(std::ostream& out, const char* str) {
+    for (; *str; ++str) {
+        if (*str == '"' || *str == '\\') {
+            out << '\\';
+        }
+        out << *str;
+    }
+}
+}  // namespace
+
+namespace trace {
+namespace detail {
+std::atomic<bool> capturing{false};
+
+std::int64_t now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                 std::chrono::steady_clock::now() - startTime)
+          .count();
+}
+
+void record(const char* name, std::int64_t begin, std::int64_t end) {
+    auto& buffer = getThreadBuffer();
+    const auto capture = currentCapture.load(std::memory_order_acquire);
+    if (buffer.capture.load(std::memory_order_relaxed) != capture) {
+        // the first event of a new capture on this thread
+        buffer.size.store(0, std::memory_order_relaxed);
+        buffer.dropped.store(0, std::memory_order_relaxed);
+        buffer.capture.store(capture, std::memory_order_release);
+    }
+    const auto size = buffer.size.load(std::memory_order_relaxed);
+    if (size == eventsPerThread) {
+        buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    buffer.events[size] = {name, begin, end};
+    buffer.size.store(size + 1, std::memory_order_release);
+}
+}  // namespace detail
+
+void captureFrames(std::size_t frames) {
+    detail::capturing.store(false, std::memory_order_relaxed);
+    currentCapture.fetch_add(1, std::memory_order_release);
+    capturePending = true;
+    framesToCapture = std::max<std::size_t>(frames, 1);
+}
+
+bool isCapturing() {
+    return capturePending ||
+           detail::capturing.load(std::memory_order_relaxed);
+}
+
+bool markFrame() {
+    const auto time = detail::now();
+    const auto lastMark = std::exchange(lastFrameMark, time);
+    if (capturePending) {
+        capturePending = false;
+        framesLeft = framesToCapture;
+        detail::capturing.store(true, std::memory_order_relaxed);
+        return false;
+    }
+    if (!detail::capturing.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    detail::record("frame", lastMark, time);
+    if (--framesLeft == 0) {
+        detail::capturing.store(false, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+void writeJSON(const fs::AbsolutePath& path) {
+    std::ofstream file{path.get()};
+    if (!file) {
+        throw fs::error_opening_file{path.get()};
+    }
+    const auto capture = currentCapture.load(std::memory_order_acquire);
+    std::lock_guard<std::mutex> lock{buffersMutex};
+    file << std::fixed << std::setprecision(3)
+         << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    auto separate = [&] {
+        if (!first) {
+            file << ",\n";
+        }
+        first = false;
+    };
+    for (const auto& buffer : buffers) {
+        if (buffer->capture.load(std::memory_order_acquire) != capture) {
+            continue;
+        }
+        separate();
+        file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+             << buffer->id << ",\"args\":{\"name\":\"thread " << buffer->id
+             << "\"}}";
+        const auto size = buffer->size.load(std::memory_order_acquire);
+        for (std::size_t i = 0; i < size; ++i) {
+            const auto& event = buffer->events[i];
+            separate();
+            file << "{\"name\":\"";
+            writeEscaped(file, event.name);
+            // microseconds
+            file << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->id
+                 << ",\"ts\":" << event.begin / 1000.
+                 << ",\"dur\":" << (event.end - event.begin) / 1000. << '}';
+        }
+        if (const auto dropped =
+                  buffer->dropped.load(std::memory_order_relaxed)) {
+            // as an instant event at the start of the thread's timeline
+            separate();
+            file << "{\"name\":\"" << dropped << " events dropped\","
+                 << "\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":" << buffer->id
+                 << ",\"ts\":0}";
+        }
+    }
+    file << "]}\n";
+}
+}  // namespace trace
+
+NS_KEPLER_END
@@ -0,0 +1,63 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include "data/fs.hpp"
+#include "kepler_config.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+NS_KEPLER_BEGIN
+
+// CPU-side timeline of what each thread spends its time on, captured a few
+// frames at a time and written out as Chrome trace-event JSON (for
+// chrome://tracing or ui.perfetto.dev). while nothing is being captured a
+// scope costs one relaxed atomic load. each thread appends to its own buffer,
+// so recording takes no locks.
+namespace trace {
+namespace detail {
+extern std::atomic<bool> capturing;
+std::int64_t now();
+void record(const char* name, std::int64_t begin, std::int64_t end);
+}  // namespace detail
+
+// the name must outlive the capture; string literals are best
+class Scope {
+   public:
+    explicit Scope(const char* in_name)
+        : name{in_name}
+        , begin{detail::capturing.load(std::memory_order_relaxed)
+                      ? detail::now()
+                      : -1} {}
+    ~Scope() {
+        if (begin >= 0) {
+            detail::record(name, begin, detail::now());
+        }
+    }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+   private:
+    const char* name;
+    std::int64_t begin;
+};
+
+// starts capturing at the next frame, and stops after the given number of
+// them. anything captured before is forgotten.
+void captureFrames(std::size_t frames);
+bool isCapturing();
+
+// call once per frame, between frames. returns whether a capture just
+// finished.
+bool markFrame();
+
+// the last capture. events that didn't fit in their thread's buffer are left
+// out. throws fs::error_opening_file.
+void writeJSON(const fs::AbsolutePath& path);
+}  // namespace trace
+
+NS_KEPLER_END
+
+#endif
@@ -0,0 +1,179 @@
+#include "window/headless_context.hpp"
+#include "gl/extensions.hpp"
+#include "gl/gl.hpp"
+#include "util/util.hpp"
+#include "window/window.hpp"
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include <cassert>
+#include <chrono>
+#include <cstring>
+
+NS_KEPLER_BEGIN
+
+namespace {
+EGLDisplay getDisplay() {
+    // prefer Mesa's surfaceless platform, which needs neither a display server
+    // nor a GPU. otherwise fall back to whatever the default display is.
+    const char* const extensions =
+          eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (extensions &&
+        std::strstr(extensions, "EGL_MESA_platform_surfaceless")) {
+        const auto getPlatformDisplay =
+              reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+                    eglGetProcAddress("eglGetPlatformDisplayEXT"));
+        if (getPlatformDisplay) {
+            const auto display = getPlatformDisplay(
+                  EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+            if (display != EGL_NO_DISPLAY) {
+                return display;
+            }
+        }
+    }
+    return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+struct TerminateDisplay {
+    void operator()(EGLDisplay display) const { eglTerminate(display); }
+};
+
+struct HeadlessContext_base : util::NonMovable {
+    HeadlessContext_base()
+        : display{[] {
+            const auto display = getDisplay();
+            if (display == EGL_NO_DISPLAY ||
+                !eglInitialize(display, nullptr, nullptr)) {
+                throw initialization_error{"Unable to initialize EGL"};
+            }
+            return display;
+        }()}
+        , context{EGL_NO_CONTEXT} {
+        if (!eglBindAPI(EGL_OPENGL_API)) {
+            throw initialization_error{"EGL doesn't support desktop OpenGL"};
+        }
+
+        // the default EGL_SURFACE_TYPE is EGL_WINDOW_BIT, which surfaceless
+        // displays have no configs for
+        const EGLint configAttributes[] = {
+              EGL_SURFACE_TYPE,
+              0,
+              EGL_RENDERABLE_TYPE,
+              EGL_OPENGL_BIT,
+              EGL_NONE,
+        };
+        EGLConfig config;
+        EGLint configCount;
+        if (!eglChooseConfig(display, configAttributes, &config, 1,
+                             &configCount) ||
+            configCount < 1) {
+            throw initialization_error{"No suitable EGL config"};
+        }
+
+        const EGLint contextAttributes[] = {
+              EGL_CONTEXT_MAJOR_VERSION,
+              GL::Version::Major,
+              EGL_CONTEXT_MINOR_VERSION,
+              GL::Version::Minor,
+              EGL_CONTEXT_OPENGL_PROFILE_MASK,
+              EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+              EGL_NONE,
+        };
+        context = eglCreateContext(display, config, EGL_NO_CONTEXT,
+                                   contextAttributes);
+        if (context == EGL_NO_CONTEXT) {
+            throw initialization_error{"Unable to create EGL context"};
+        }
+        // no surface at all, which requires EGL_KHR_surfaceless_context
+        if (!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE,
+                            context)) {
+            eglDestroyContext(display, context);
+            throw initialization_error{"Unable to make EGL context current"};
+        }
+
+        const auto loader = reinterpret_cast<GLADloadproc>(eglGetProcAddress);
+        int gladInitRes = gladLoadGLLoader(loader);
+        if (!gladInitRes) {
+            eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE,
+                           EGL_NO_CONTEXT);
+            eglDestroyContext(display, context);
+            throw initialization_error{"Unable to initialize glad"};
+        }
+        GL::extensions::load(loader);
+        GL::state::invalidate();
+    }
+    ~HeadlessContext_base() {
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE,
+                       EGL_NO_CONTEXT);
+        eglDestroyContext(display, context);
+    }
+
+    util::RAII<EGLDisplay, TerminateDisplay> display;
+    EGLContext context;
+};
+}  // namespace
+
+struct HeadlessContext::Impl : HeadlessContext_base {
+    Impl(Resolution in_resolution)
+        : resolution{in_resolution}
+        , output{resolution,
+                 FrameBuffer::Attachments::Options{
+                       {GL_RGBA, GL_UNSIGNED_BYTE, GL_RGBA8}, false, false}}
+        , startTime{std::chrono::steady_clock::now()} {
+        GL_CHECK(glViewport(0, 0, resolution.width(), resolution.height()));
+    }
+
+    std::vector<unsigned char> readPixels() const {
+        std::vector<unsigned char> pixels(4 * resolution.width() *
+                                          resolution.height());
+        GL::state::bindFramebuffer(GL_READ_FRAMEBUFFER, output.getHandle());
+        GL_CHECK(glPixelStorei(GL_PACK_ALIGNMENT, 1));
+        GL_CHECK(glReadPixels(0, 0, resolution.width(), resolution.height(),
+                              GL_RGBA, GL_UNSIGNED_BYTE, pixels.data()));
+        return pixels;
+    }
+
+    Seconds getTime() const {
+        return {std::chrono::duration<float>(std::chrono::steady_clock::now() -
+                                             startTime)
+                      .count()};
+    }
+
+    Resolution resolution;
+    FrameBuffer output;
+    std::chrono::steady_clock::time_point startTime;
+};
+
+HeadlessContext::HeadlessContext(Resolution resolution)
+    : impl{std::make_unique<Impl>(resolution)} {}
+HeadlessContext::HeadlessContext(HeadlessContext&&) = default;
+HeadlessContext& HeadlessContext::operator=(HeadlessContext&&) = default;
+HeadlessContext::~HeadlessContext() = default;
+
+Resolution HeadlessContext::getResolution() const {
+    assert(impl);
+    return impl->resolution;
+}
+
+FrameBuffer::View HeadlessContext::getOutputFramebuffer() const {
+    assert(impl);
+    return impl->output;
+}
+
+std::vector<unsigned char> HeadlessContext::readPixels() const {
+    assert(impl);
+    return impl->readPixels();
+}
+
+void HeadlessContext::finish() {
+    assert(impl);
+    GL_CHECK(glFinish());
+}
+
+Seconds HeadlessContext::getTime() const {
+    assert(impl);
+    return impl->getTime();
+}
+
+NS_KEPLER_END
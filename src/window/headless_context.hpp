@@ -0,0 +1,44 @@
+#ifndef HEADLESS_CONTEXT_HPP
+#define HEADLESS_CONTEXT_HPP
+
+#include "common/common.hpp"
+#include "common/types.hpp"
+#include "gl/frame_buffer.hpp"
+
+#include <memory>
+#include <vector>
+
+NS_KEPLER_BEGIN
+
+// an OpenGL context with no window or display server behind it (EGL
+// surfaceless, which Mesa's llvmpipe also provides). there is no default
+// framebuffer, so frames are rendered into an offscreen FrameBuffer with a
+// fixed resolution, which can then be read back to the CPU.
+class HeadlessContext {
+   public:
+    explicit HeadlessContext(Resolution resolution);
+    HeadlessContext(HeadlessContext&&);
+    HeadlessContext& operator=(HeadlessContext&&);
+    ~HeadlessContext();
+
+    Resolution getResolution() const;
+
+    // point Renderer::setOutputFramebuffer at this
+    FrameBuffer::View getOutputFramebuffer() const;
+
+    // tightly packed RGBA8, bottom row first (as glReadPixels returns it)
+    std::vector<unsigned char> readPixels() const;
+
+    // blocks until all submitted GL work has finished
+    void finish();
+
+    Seconds getTime() const;
+
+   private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+};
+
+NS_KEPLER_END
+
+#endif
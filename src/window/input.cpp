@@ -24,6 +24,12 @@ int getKey(Input::Key key) {
             return GLFW_KEY_E;
         case Input::Key::B:
             return GLFW_KEY_B;
+        case Input::Key::G:
+            return GLFW_KEY_G;
+        case Input::Key::R:
+            return GLFW_KEY_R;
+        case Input::Key::T:
+            return GLFW_KEY_T;
         case Input::Key::Esc:
             return GLFW_KEY_ESCAPE;
         case Input::Key::LeftArrow:
@@ -23,6 +23,9 @@ class Input {
         Q,
         E,
         B,
+        G,
+        R,
+        T,
         Esc,
         LeftArrow,
         RightArrow,
@@ -1,5 +1,8 @@
 #include "window/window.hpp"
 #include "common/common.hpp"
+#include "gl/extensions.hpp"
+#include "gl/state.hpp"
+#include "util/trace.hpp"
 #include "util/util.hpp"
 #include "window/input.inl"
 
@@ -74,12 +77,19 @@ struct Window::Impl : Window_base {
         if (!gladInitRes) {
             throw initialization_error{"Unable to initialize glad"};
         }
+        GL::extensions::load(
+              reinterpret_cast<GLADloadproc>(glfwGetProcAddress));
+        GL::state::invalidate();
     }
 
     bool shouldClose() const { return glfwWindowShouldClose(window); }
 
     void update() {
-        glfwSwapBuffers(window);
+        {
+            trace::Scope trace{"swap buffers"};
+            glfwSwapBuffers(window);
+        }
+        trace::Scope trace{"poll events"};
         glfwPollEvents();
         input.update();
         if (global_windowSizeDirty) {
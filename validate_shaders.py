@@ -3,11 +3,26 @@
 from __future__ import print_function
 import argparse
 import os
+import re
 import subprocess as sp
 import sys
 
 _VALIDATOR = 'glslangValidator'
 _EXTS = ['.vert', '.tesc', '.tese', '.geom', '.frag', '.comp']
+_INCLUDE = re.compile(r'^[ \t]*#[ \t]*include[ \t]*"([^"]*)".*$', re.MULTILINE)
+
+
+# like ShaderSources does it, each file once. defines are left out, so
+# shaders are checked as whatever their #ifs choose without them.
+def expand_includes(source, dir_, included):
+    def include(match):
+        name = match.group(1)
+        if name in included:
+            return ''
+        included.add(name)
+        with open(os.path.join(dir_, name), r'r') as snippet:
+            return expand_includes(snippet.read(), dir_, included)
+    return _INCLUDE.sub(include, source)
 
 
 def validate_shaders(dir_, version_string):
@@ -17,7 +32,8 @@ def validate_shaders(dir_, version_string):
             if ext in _EXTS:
                 name = os.path.join(dirpath, file_name)
                 with open(name, r'r') as shader:
-                    source = version_string + shader.read()
+                    source = version_string + \
+                        expand_includes(shader.read(), dir_, set())
                     p = sp.Popen(
                         [_VALIDATOR, '--stdin', '-S', ext[1:]], stdin=sp.PIPE, stdout=sp.PIPE, stderr=sp.PIPE)
                     error = p.communicate(input=source)[0]